@@ -0,0 +1,71 @@
+#!/bin/sh
+# Load test a dedicated server with a swarm of headless bot clients, no EOS credentials needed.
+# Usage : ./Bots.sh [NumberOfBots] [ServerAddress|local] [DurationInSeconds] [BotsPerProcess]
+# One process drives BotsPerProcess connections, the server must run with -AllowBots to answer their pings.
+# With "local", a Null OSS dedicated server is started on PORT (7777) and stopped once the bots are done.
+# Every bot writes Saved/BotReports/Bot_<Id>.csv, merged into Saved/BotReports/BotReport.csv once they all quit.
+
+NUMBER_OF_BOTS=${1:-16}
+SERVER_ADDRESS=${2:-local}
+DURATION=${3:-60}
+BOTS_PER_PROCESS=${4:-8}
+PORT=${PORT:-7777}
+
+UNREAL_EDITOR=${UNREAL_EDITOR:-"$HOME/UnrealEngine/Engine/Binaries/Linux/UnrealEditor"}
+PROJECT_DIR=$(cd "$(dirname "$0")" && pwd)
+REPORT_DIR="$PROJECT_DIR/Saved/BotReports"
+
+mkdir -p "$REPORT_DIR"
+rm -f "$REPORT_DIR"/Bot_*.csv "$REPORT_DIR/BotReport.csv"
+
+# Null identities and plain IP sockets, the server hosts its sessions with the Null OSS so the bots get registered
+SERVER_PID=""
+if [ "$SERVER_ADDRESS" = "local" ]; then
+	"$UNREAL_EDITOR" "$PROJECT_DIR/EOSTutorial.uproject" ThirdPersonMap -server -nullrhi -nosound -unattended -port="$PORT" -AllowBots \
+		-ini:Engine:[OnlineSubsystem]:DefaultPlatformService=Null,[/Script/OnlineSubsystemEOS.NetDriverEOS]:bIsUsingP2PSockets=False \
+		-ini:Game:[/Script/Engine.GameSession]:MaxSplitscreensPerConnection="$BOTS_PER_PROCESS",[/Script/EOSTutorial.EOS_GameSession]:MaxNumberOfPlayersInSession="$NUMBER_OF_BOTS" \
+		-log="Bots_Server.log" > /dev/null 2>&1 &
+	SERVER_PID=$!
+	SERVER_ADDRESS="127.0.0.1:$PORT"
+	sleep 10
+fi
+
+# Every process is headless (-nullrhi) and silent (-nosound), its bots join as child connections of its first one
+BOT_ID=0
+BOT_PIDS=""
+while [ "$BOT_ID" -lt "$NUMBER_OF_BOTS" ]; do
+	COUNT=$((NUMBER_OF_BOTS - BOT_ID))
+	[ "$COUNT" -gt "$BOTS_PER_PROCESS" ] && COUNT=$BOTS_PER_PROCESS
+	"$UNREAL_EDITOR" "$PROJECT_DIR/EOSTutorial.uproject" ThirdPersonMap -game -nullrhi -nosound -unattended -nosplash \
+		-EOSBot -BotId="$BOT_ID" -BotsPerProcess="$COUNT" -BotServer="$SERVER_ADDRESS" -BotDuration="$DURATION" -BotReportDir="$REPORT_DIR" \
+		-log="Bot_$BOT_ID.log" > /dev/null 2>&1 &
+	BOT_PIDS="$BOT_PIDS $!"
+	BOT_ID=$((BOT_ID + COUNT))
+	sleep 0.2 # Don't hit the server with every handshake on the same frame
+done
+
+for BOT_PID in $BOT_PIDS; do
+	wait "$BOT_PID"
+done
+[ -n "$SERVER_PID" ] && kill "$SERVER_PID" 2> /dev/null
+
+# Keep the header of the first report only
+FIRST=1
+for REPORT in "$REPORT_DIR"/Bot_*.csv; do
+	[ -f "$REPORT" ] || continue
+	if [ "$FIRST" -eq 1 ]; then
+		cat "$REPORT" >> "$REPORT_DIR/BotReport.csv"
+		FIRST=0
+	else
+		tail -n +2 "$REPORT" >> "$REPORT_DIR/BotReport.csv"
+	fi
+done
+
+if [ "$FIRST" -eq 1 ]; then
+	echo "No bot report found in $REPORT_DIR"
+	exit 1
+fi
+
+# Swarm summary : bots that joined, average join latency, average RTT and worst server frame
+awk -F, 'NR > 1 { if ($2 >= 0) { Joined++; Join += $2 } Rtt += $3; if ($11 > Frame) Frame = $11; Bots++ }
+	END { printf "%d/%d bots joined - Join avg %.1f ms - RTT avg %.1f ms - Server frame max %.1f ms\n", Joined, Bots, Joined ? Join / Joined : -1, Bots ? Rtt / Bots : -1, Frame }' "$REPORT_DIR/BotReport.csv"
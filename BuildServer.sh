@@ -0,0 +1,33 @@
+#!/bin/sh
+# Build, cook and stage the Linux dedicated server, the build Fleet.sh starts.
+# Usage : ./BuildServer.sh [Configuration]
+# A cooked server skips the editor and the DDC entirely, only ThirdPersonMap and what it references are cooked and paked.
+# The EOSTutorialServer target layers Config/Custom/DedicatedServer over the project config, renderer features are off
+# and materials are redirected to the engine default one, so textures and materials are left out of the cook cleanly.
+# EOS.ServerMemory on the server lists what render data is still loaded, and the resident memory of the process.
+# Each server start logs how long every phase took and appends it to Saved/Logs/StartupTrace.csv, see FEOSStartupTrace.
+
+CONFIGURATION=${1:-Development}
+
+UNREAL_ENGINE=${UNREAL_ENGINE:-"$HOME/UnrealEngine"}
+PROJECT_DIR=$(cd "$(dirname "$0")" && pwd)
+BUILD_LOG="$PROJECT_DIR/Saved/Logs/BuildServer.log"
+mkdir -p "$PROJECT_DIR/Saved/Logs"
+
+# Shown as it goes and kept for the cook check below, the exit code is passed through a file since a pipe drops it
+{
+	"$UNREAL_ENGINE/Engine/Build/BatchFiles/RunUAT.sh" BuildCookRun -project="$PROJECT_DIR/EOSTutorial.uproject" \
+		-noclient -server -serverplatform=Linux -serverconfig="$CONFIGURATION" -map=ThirdPersonMap \
+		-build -cook -stage -pak -iostore -compressed -unattended -utf8output -nop4 -CustomConfig=DedicatedServer \
+		-stagingdirectory="$PROJECT_DIR/Saved/StagedBuilds" 2>&1
+	echo $? > "$BUILD_LOG.status"
+} | tee "$BUILD_LOG"
+[ "$(cat "$BUILD_LOG.status")" = "0" ] || exit 1
+
+# A clean cook: the server material redirect left no reference into the never cooked material and texture directories
+if grep -E "(Warning|Error).*/Game/(Characters/Mannequins|Characters/Mannequin_UE4|LevelPrototyping)/(Materials|Textures)/" "$BUILD_LOG"; then
+	echo "The server cook still references never cooked materials or textures, add them to [CoreRedirects] in Config/Custom/DedicatedServer/DefaultEngine.ini"
+	exit 1
+fi
+
+echo "Server staged in $PROJECT_DIR/Saved/StagedBuilds/LinuxServer"
@@ -0,0 +1,122 @@
+#!/bin/sh
+# Run a fleet of dedicated servers on this Linux machine, each on its own port, and keep it sized to the demand.
+# Usage : ./Fleet.sh [MinServers] [MaxServers] [FirstPort]
+# Every server rewrites Saved/Fleet/Server_<Port>.status once a second (players, capacity, open slots, tick time)
+# and applies Saved/Fleet/Server_<Port>.command (advertise=0|1, drain=0|1), see UEOS_FleetAgentSubsystem.
+# - Servers are pre-spawned so at least SPARE_SLOTS player slots stay open ahead of demand
+# - Only the least loaded servers advertise new matches, until they cover SPARE_SLOTS
+# - Crashed or hung servers are killed and replaced, idle servers above MinServers are drained
+# Clients find the servers through their EOS sessions, which advertise PUBLIC_ADDRESS and the server port.
+
+MIN_SERVERS=${1:-2}
+MAX_SERVERS=${2:-8}
+FIRST_PORT=${3:-7777}
+SPARE_SLOTS=${SPARE_SLOTS:-4}
+HEARTBEAT_TIMEOUT=${HEARTBEAT_TIMEOUT:-30} # Seconds without a status before a server is considered hung, startup included
+PUBLIC_ADDRESS=${PUBLIC_ADDRESS:-$(hostname -I 2> /dev/null | awk '{ print $1 }')}
+PUBLIC_ADDRESS=${PUBLIC_ADDRESS:-127.0.0.1}
+
+PROJECT_DIR=$(cd "$(dirname "$0")" && pwd)
+UNREAL_SERVER=${UNREAL_SERVER:-"$PROJECT_DIR/Saved/StagedBuilds/LinuxServer/EOSTutorial/Binaries/Linux/EOSTutorialServer"} # Cooked by BuildServer.sh
+FLEET_DIR="$PROJECT_DIR/Saved/Fleet"
+
+mkdir -p "$FLEET_DIR"
+rm -f "$FLEET_DIR"/Server_*
+
+start_server() { # Port
+	"$UNREAL_SERVER" ThirdPersonMap -port="$1" -FleetDir="$FLEET_DIR" -PublicAddress="$PUBLIC_ADDRESS" -epicapp="ServerArtifact" \
+		-unattended -log="Server_$1.log" > /dev/null 2>&1 &
+	echo $! > "$FLEET_DIR/Server_$1.pid"
+	date +%s > "$FLEET_DIR/Server_$1.started"
+	echo "Started server on port $1 (pid $!)"
+}
+
+stop_server() { # Port
+	kill -9 "$(cat "$FLEET_DIR/Server_$1.pid")" 2> /dev/null
+	rm -f "$FLEET_DIR/Server_$1".*
+}
+
+status_value() { # Port Key
+	sed -n "s/^$2=//p" "$FLEET_DIR/Server_$1.status" 2> /dev/null
+}
+
+write_command() { # Port Advertise Drain - Moved over the old one, a server never reads half a file
+	printf 'advertise=%d\ndrain=%d\n' "$2" "$3" > "$FLEET_DIR/Server_$1.command.tmp"
+	mv "$FLEET_DIR/Server_$1.command.tmp" "$FLEET_DIR/Server_$1.command"
+}
+
+stop_fleet() {
+	for PID_FILE in "$FLEET_DIR"/Server_*.pid; do
+		[ -f "$PID_FILE" ] && kill "$(cat "$PID_FILE")" 2> /dev/null
+	done
+	wait
+	rm -f "$FLEET_DIR"/Server_*
+	exit 0
+}
+trap stop_fleet INT TERM
+
+echo "Fleet of $MIN_SERVERS to $MAX_SERVERS servers from port $FIRST_PORT, advertised at $PUBLIC_ADDRESS"
+while true; do
+	NOW=$(date +%s)
+	RUNNING=0 # Servers taking players, starting ones included
+	STARTING=0
+	FREE_PORT=0
+	LOADS=""
+
+	PORT=$FIRST_PORT
+	while [ "$PORT" -lt $((FIRST_PORT + MAX_SERVERS)) ]; do
+		if [ ! -f "$FLEET_DIR/Server_$PORT.pid" ]; then
+			[ "$FREE_PORT" -eq 0 ] && FREE_PORT=$PORT
+		elif ! kill -0 "$(cat "$FLEET_DIR/Server_$PORT.pid")" 2> /dev/null; then
+			# Drained servers quit on their own once empty, anything else crashed
+			if [ -f "$FLEET_DIR/Server_$PORT.draining" ]; then
+				echo "Server on port $PORT drained"
+			else
+				echo "Server on port $PORT exited unexpectedly"
+			fi
+			stop_server "$PORT"
+		elif [ ! -f "$FLEET_DIR/Server_$PORT.status" ]; then
+			if [ $((NOW - $(cat "$FLEET_DIR/Server_$PORT.started"))) -gt "$HEARTBEAT_TIMEOUT" ]; then
+				echo "Server on port $PORT never reported, replacing it"
+				stop_server "$PORT"
+			else
+				RUNNING=$((RUNNING + 1))
+				STARTING=$((STARTING + 1))
+			fi
+		elif [ $((NOW - $(stat -c %Y "$FLEET_DIR/Server_$PORT.status"))) -gt "$HEARTBEAT_TIMEOUT" ]; then
+			echo "Server on port $PORT stopped reporting, replacing it"
+			stop_server "$PORT"
+		elif [ ! -f "$FLEET_DIR/Server_$PORT.draining" ]; then
+			RUNNING=$((RUNNING + 1))
+			LOADS="$LOADS$(status_value "$PORT" players) $PORT $(status_value "$PORT" capacity)
+"
+		fi
+		PORT=$((PORT + 1))
+	done
+
+	# Least loaded first : advertise until their free slots cover the spare slots, hold the others.
+	# Also the free slots of the whole fleet, and the last idle server with its capacity, to drain it if it is surplus.
+	DECISIONS=$(printf '%s' "$LOADS" | sort -n -k1,1 | awk -v Spare="$SPARE_SLOTS" '
+		NF == 3 { Free = $3 - $1; Advertise = Advertised < Spare; if (Advertise) Advertised += Free; print $2, Advertise; Total += Free; if ($1 == 0) { Idle = $2; IdleCapacity = $3 } }
+		END { print "total", Total + 0; print "idle", Idle + 0, IdleCapacity + 0 }')
+	echo "$DECISIONS" | while read -r SERVER_PORT ADVERTISE EXTRA; do
+		case $SERVER_PORT in
+			total|idle) ;;
+			*) write_command "$SERVER_PORT" "$ADVERTISE" 0 ;;
+		esac
+	done
+	TOTAL_FREE=$(echo "$DECISIONS" | awk '$1 == "total" { print $2 }')
+	IDLE_PORT=$(echo "$DECISIONS" | awk '$1 == "idle" { print $2 }')
+	IDLE_CAPACITY=$(echo "$DECISIONS" | awk '$1 == "idle" { print $3 }')
+
+	# One server at a time, starting servers have not told their capacity yet
+	if [ "$STARTING" -eq 0 ] && [ "$FREE_PORT" -ne 0 ] && { [ "$RUNNING" -lt "$MIN_SERVERS" ] || [ "$TOTAL_FREE" -lt "$SPARE_SLOTS" ]; }; then
+		start_server "$FREE_PORT"
+	elif [ "$RUNNING" -gt "$MIN_SERVERS" ] && [ "$IDLE_PORT" -ne 0 ] && [ $((TOTAL_FREE - IDLE_CAPACITY)) -ge "$SPARE_SLOTS" ]; then
+		echo "Draining idle server on port $IDLE_PORT"
+		write_command "$IDLE_PORT" 0 1
+		touch "$FLEET_DIR/Server_$IDLE_PORT.draining"
+	fi
+
+	sleep 1
+done
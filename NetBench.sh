@@ -0,0 +1,105 @@
+#!/bin/sh
+# Benchmark the game net driver under emulated packet loss, latency and jitter, headless, on this machine.
+# Usage : ./NetBench.sh [Label] [NumberOfBots] [DurationInSeconds]
+#         ./NetBench.sh compare <Results.csv> <OtherResults.csv>
+# Every configuration runs a dedicated server and its bots (see Bots.sh) over each transport :
+# - Ip : the plain IpNetDriver
+# - EOSLoopback : NetDriverEOS with its P2P sockets off, over loopback - Stands in for P2P, which needs EOS credentials
+# Emulation is applied by both ends to what they send (-PktLoss, -PktLag, -PktLagVariance), the round trip is twice the lag.
+# Every process writes its measures, see UEOS_NetBenchSubsystem. Saved/NetBench/<Label>.csv gets one line per configuration,
+# comparable with the results of another build through the compare mode.
+
+if [ "$1" = "compare" ]; then
+	# Joined on the configuration, every measure of the first file next to the second one and the change
+	awk -F, 'FNR == 1 { for (i = 1; i <= NF; i++) Column[i] = $i; Columns = NF; next }
+		{ Key = $2 " loss " $3 "% lag " $4 " ms jitter " $5 " ms" }
+		NR == FNR { for (i = 7; i <= Columns; i++) Before[Key, i] = $i; next }
+		(Key, 7) in Before {
+			print Key
+			for (i = 7; i <= Columns; i++) {
+				Change = Before[Key, i] != 0 ? sprintf("%+.1f%%", ($i - Before[Key, i]) * 100 / Before[Key, i]) : "-"
+				printf "  %-28s %12s %12s %10s\n", Column[i], Before[Key, i], $i, Change
+			}
+		}' "$2" "$3"
+	exit 0
+fi
+
+LABEL=${1:-$(git -C "$(dirname "$0")" rev-parse --short HEAD 2> /dev/null || date +%Y%m%d%H%M%S)}
+NUMBER_OF_BOTS=${2:-4}
+DURATION=${3:-30}
+TRANSPORTS=${TRANSPORTS:-"Ip EOSLoopback"}
+PACKET_LOSSES=${PACKET_LOSSES:-"0 1 5"} # Percent
+LAGS=${LAGS:-"0 50 100"} # Milliseconds, each way
+JITTERS=${JITTERS:-"0 20"} # Milliseconds
+PORT=${PORT:-7790}
+
+UNREAL_EDITOR=${UNREAL_EDITOR:-"$HOME/UnrealEngine/Engine/Binaries/Linux/UnrealEditor"}
+PROJECT_DIR=$(cd "$(dirname "$0")" && pwd)
+BENCH_DIR="$PROJECT_DIR/Saved/NetBench"
+RUN_DIR="$BENCH_DIR/Run"
+RESULTS="$BENCH_DIR/$LABEL.csv"
+
+mkdir -p "$BENCH_DIR"
+echo "Label,Transport,PktLoss,PktLag,PktLagVariance,Bots,ServerInKBps,ServerOutKBps,ServerCpuUsPerPacket,ClientInKBps,ClientOutKBps,ClientCpuUsPerPacket,ClientPacketsLost,ReplicationLatencyAvgMs,ReplicationLatencyP95Ms,CorrectionsPerSecond,RttAvgMs" > "$RESULTS"
+
+run_configuration() { # Transport PacketLoss Lag Jitter
+	rm -rf "$RUN_DIR"
+	mkdir -p "$RUN_DIR"
+	EMULATION="-PktLoss=$2 -PktLag=$3 -PktLagVariance=$4"
+	TRANSPORT_ARGS="-NetBench -NetBenchTransport=$1 -NetBenchDuration=$DURATION"
+	[ "$1" = "EOSLoopback" ] && TRANSPORT_ARGS="$TRANSPORT_ARGS -ini:Engine:[/Script/OnlineSubsystemEOS.NetDriverEOS]:bIsUsingP2PSockets=False"
+
+	# The server measures from the first connection and quits after DURATION
+	"$UNREAL_EDITOR" "$PROJECT_DIR/EOSTutorial.uproject" ThirdPersonMap -server -nullrhi -nosound -unattended -port="$PORT" -AllowBots \
+		$TRANSPORT_ARGS $EMULATION -NetBenchReport="$RUN_DIR/Server.csv" -log="NetBench_Server.log" > /dev/null 2>&1 &
+	SERVER_PID=$!
+	sleep 10
+
+	BOT_ID=0
+	BOT_PIDS=""
+	while [ "$BOT_ID" -lt "$NUMBER_OF_BOTS" ]; do
+		"$UNREAL_EDITOR" "$PROJECT_DIR/EOSTutorial.uproject" ThirdPersonMap -game -nullrhi -nosound -unattended -nosplash \
+			-EOSBot -BotId="$BOT_ID" -BotServer="127.0.0.1:$PORT" -BotDuration="$DURATION" -BotReportDir="$RUN_DIR" \
+			$TRANSPORT_ARGS $EMULATION -NetBenchReport="$RUN_DIR/Client_$BOT_ID.csv" -log="NetBench_Bot_$BOT_ID.log" > /dev/null 2>&1 &
+		BOT_PIDS="$BOT_PIDS $!"
+		BOT_ID=$((BOT_ID + 1))
+	done
+	for BOT_PID in $BOT_PIDS; do
+		wait "$BOT_PID"
+	done
+
+	# A server nobody reached never ends its window
+	TIMEOUT=30
+	while kill -0 "$SERVER_PID" 2> /dev/null && [ "$TIMEOUT" -gt 0 ]; do
+		sleep 1
+		TIMEOUT=$((TIMEOUT - 1))
+	done
+	kill "$SERVER_PID" 2> /dev/null
+	wait "$SERVER_PID" 2> /dev/null
+
+	# Server line, then the average of the client lines and of the bot round trips, by column name
+	awk -F, -v Prefix="$LABEL,$1,$2,$3,$4,$NUMBER_OF_BOTS" '
+		FNR == 1 { delete Column; for (i = 1; i <= NF; i++) Column[$i] = i; next }
+		$Column["Role"] == "Server" { ServerIn = $Column["InKBps"]; ServerOut = $Column["OutKBps"]; ServerCpu = $Column["CpuUsPerPacket"]; next }
+		$Column["Role"] == "Client" { Clients++; In += $Column["InKBps"]; Out += $Column["OutKBps"]; Cpu += $Column["CpuUsPerPacket"]; Lost += $Column["InPacketsLost"]
+			Latency += $Column["ReplicationLatencyAvgMs"]; LatencyP95 += $Column["ReplicationLatencyP95Ms"]; Corrections += $Column["CorrectionsPerSecond"]; next }
+		"RttAvgMs" in Column { Bots++; Rtt += $Column["RttAvgMs"] }
+		END { if (!Clients) Clients = 1; if (!Bots) Bots = 1
+			printf "%s,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.1f,%.2f,%.2f,%.3f,%.2f\n", Prefix, ServerIn, ServerOut, ServerCpu,
+				In / Clients, Out / Clients, Cpu / Clients, Lost / Clients, Latency / Clients, LatencyP95 / Clients, Corrections / Clients, Rtt / Bots }' \
+		"$RUN_DIR"/*.csv >> "$RESULTS"
+	tail -n 1 "$RESULTS"
+}
+
+for TRANSPORT in $TRANSPORTS; do
+	for PACKET_LOSS in $PACKET_LOSSES; do
+		for LAG in $LAGS; do
+			for JITTER in $JITTERS; do
+				echo "$TRANSPORT - loss $PACKET_LOSS% lag $LAG ms jitter $JITTER ms"
+				run_configuration "$TRANSPORT" "$PACKET_LOSS" "$LAG" "$JITTER"
+			done
+		done
+	done
+done
+
+echo "Results in $RESULTS"
@@ -2,6 +2,13 @@
 
 #include "EOSTutorial.h"
 #include "Modules/ModuleManager.h"
+#include "EOS_ReplayStreamer.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, EOSTutorial, "EOSTutorial" );
- 
\ No newline at end of file
+TSharedPtr<INetworkReplayStreamer> FEOSTutorialModule::CreateReplayStreamer()
+{
+	TSharedPtr<FEOSReplayStreamer> Streamer = MakeShared<FEOSReplayStreamer>();
+	LocalFileStreamers.Add(Streamer);
+	return Streamer;
+}
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FEOSTutorialModule, EOSTutorial, "EOSTutorial" );
@@ -3,3 +3,16 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "LocalFileNetworkReplayStreaming.h"
+
+/**
+ * Game module, also the replay streaming factory picked by [NetworkReplayStreaming] DefaultFactoryName=EOSTutorial.
+ * The local file factory ticks the streamers it hands out, this one hands out compressed ones (FEOSReplayStreamer).
+ */
+class FEOSTutorialModule : public FLocalFileNetworkReplayStreamingFactory
+{
+public:
+	virtual bool IsGameModule() const override { return true; }
+
+	virtual TSharedPtr<INetworkReplayStreamer> CreateReplayStreamer() override;
+};
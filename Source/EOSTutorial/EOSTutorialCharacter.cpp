@@ -10,13 +10,50 @@
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "InputActionValue.h"
+#include "EngineUtils.h"
+#include "EOS_SignificanceManager.h"
+#include "EOS_CharacterMovementComponent.h"
+#include "EOS_LagCompensationSubsystem.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "AnimNode_ControlRig.h"
+#include "Animation/AnimInstance.h"
+#include "TimerManager.h"
+#include "EOS_NetBenchSubsystem.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Net/UnrealNetwork.h"
 
 DEFINE_LOG_CATEGORY(LogTemplateCharacter);
 
 //////////////////////////////////////////////////////////////////////////
 // AEOSTutorialCharacter
 
-AEOSTutorialCharacter::AEOSTutorialCharacter()
+FName AEOSTutorialCharacter::CameraBoomName(TEXT("CameraBoom"));
+FName AEOSTutorialCharacter::FollowCameraName(TEXT("FollowCamera"));
+
+// -FullCharacter keeps the camera of every pawn, the baseline EOS.CharacterFootprint compares the lean pawns against
+static bool IsLeanCharacter()
+{
+	static const bool bIsLeanCharacter = !FParse::Param(FCommandLine::Get(), TEXT("FullCharacter"));
+	return bIsLeanCharacter;
+}
+
+// No one ever looks through the camera of a dedicated server pawn. The object initializer skips the optional camera
+// subobjects there, so Blueprint children load their templates as null instead of failing to match them.
+static const FObjectInitializer& SkipCameraOnDedicatedServer(const FObjectInitializer& ObjectInitializer)
+{
+	if (IsRunningDedicatedServer() && IsLeanCharacter())
+	{
+		ObjectInitializer.DoNotCreateDefaultSubobject(AEOSTutorialCharacter::CameraBoomName)
+			.DoNotCreateDefaultSubobject(AEOSTutorialCharacter::FollowCameraName);
+	}
+	return ObjectInitializer;
+}
+
+AEOSTutorialCharacter::AEOSTutorialCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(SkipCameraOnDedicatedServer(ObjectInitializer).SetDefaultSubobjectClass<USkeletalMeshComponentBudgeted>(ACharacter::MeshComponentName)
+		.SetDefaultSubobjectClass<UEOS_CharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
@@ -39,28 +76,67 @@ AEOSTutorialCharacter::AEOSTutorialCharacter()
 	GetCharacterMovement()->BrakingDecelerationWalking = 2000.f;
 	GetCharacterMovement()->BrakingDecelerationFalling = 1500.0f;
 
-	// Create a camera boom (pulls in towards the player if there is a collision)
-	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
-	CameraBoom->SetupAttachment(RootComponent);
-	CameraBoom->TargetArmLength = 400.0f; // The camera follows at this distance behind the character	
-	CameraBoom->bUsePawnControlRotation = true; // Rotate the arm based on the controller
+	// Create a camera boom (pulls in towards the player if there is a collision) - Null on dedicated server
+	CameraBoom = CreateOptionalDefaultSubobject<USpringArmComponent>(CameraBoomName);
+	if (CameraBoom)
+	{
+		CameraBoom->SetupAttachment(RootComponent);
+		CameraBoom->TargetArmLength = 400.0f; // The camera follows at this distance behind the character	
+		CameraBoom->bUsePawnControlRotation = true; // Rotate the arm based on the controller
+	}
 
-	// Create a follow camera
-	FollowCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
-	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
-	FollowCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
+	// Create a follow camera - Null on dedicated server
+	FollowCamera = CreateOptionalDefaultSubobject<UCameraComponent>(FollowCameraName);
+	if (FollowCamera)
+	{
+		if (CameraBoom)
+		{
+			FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
+		}
+		FollowCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
+	}
 
 	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named ThirdPersonCharacter (to avoid direct content references in C++)
 }
 
+void AEOSTutorialCharacter::PreRegisterAllComponents()
+{
+	Super::PreRegisterAllComponents();
+
+	// Clients share an animation time budget (a.Budget.*), the budget throttles ticks and interpolates through URO.
+	// The dedicated server renders nothing, it only ticks montages for root motion and evaluates poses on request.
+	// Set on the instance before its components register, the class default stays the same in every process.
+	if (IsRunningDedicatedServer() && !HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject))
+	{
+		if (USkeletalMeshComponentBudgeted* BudgetedMesh = Cast<USkeletalMeshComponentBudgeted>(GetMesh()))
+		{
+			BudgetedMesh->SetAutoRegisterWithBudgetAllocator(false);
+		}
+		if (GetMesh())
+		{
+			GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+		}
+	}
+}
+
 void AEOSTutorialCharacter::BeginPlay()
 {
 	// Call the base class  
 	Super::BeginPlay();
 
-	//Add Input Mapping Context
-	if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
+	// Simulated proxies never get a controller, switch their camera off now
+	UpdateCameraComponents();
+
+	// Anim instances are created again when the mesh or its anim class changes
+	GetMesh()->OnAnimInitialized.AddUniqueDynamic(this, &AEOSTutorialCharacter::ApplyControlRigLODThreshold);
+	ApplyControlRigLODThreshold();
+
+	RegisterWithWorldSubsystems();
+
+	//Add Input Mapping Context - Only a local player has input to map
+	APlayerController* PlayerController = Cast<APlayerController>(Controller);
+	if (PlayerController && PlayerController->IsLocalController())
 	{
 		if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
 		{
@@ -69,6 +145,286 @@ void AEOSTutorialCharacter::BeginPlay()
 	}
 }
 
+void AEOSTutorialCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(BoneAccuratePoseTimerHandle);
+
+	UnregisterFromWorldSubsystems();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AEOSTutorialCharacter::RegisterWithWorldSubsystems()
+{
+	// Movement, animation and replication rates scale with the distance to the viewers
+	if (UEOS_SignificanceManager* SignificanceManager = UEOS_SignificanceManager::Get(GetWorld()))
+	{
+		SignificanceManager->RegisterCharacter(this);
+	}
+
+	// The server keeps a history of the capsule to validate hits where the shooter saw it
+	if (UEOS_LagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UEOS_LagCompensationSubsystem>())
+	{
+		LagCompensation->RegisterCharacter(this);
+	}
+}
+
+void AEOSTutorialCharacter::UnregisterFromWorldSubsystems()
+{
+	if (UEOS_SignificanceManager* SignificanceManager = UEOS_SignificanceManager::Get(GetWorld()))
+	{
+		SignificanceManager->UnregisterCharacter(this);
+	}
+	if (UEOS_LagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UEOS_LagCompensationSubsystem>())
+	{
+		LagCompensation->UnregisterCharacter(this);
+	}
+}
+
+void AEOSTutorialCharacter::Reset()
+{
+	UEOS_ActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UEOS_ActorPoolSubsystem>();
+	if (!ActorPool)
+	{
+		Super::Reset();
+	}
+	// Parked pawns are already reset, and APawn::Reset destroys every pawn that is not an AI's
+	else if (!ActorPool->IsPooled(this) && (!GetController() || GetController()->PlayerState))
+	{
+		DetachFromControllerPendingDestroy();
+		ActorPool->ReleaseActor(this);
+	}
+}
+
+void AEOSTutorialCharacter::OnAcquiredFromPool()
+{
+	GetCharacterMovement()->SetDefaultMovementMode();
+	RegisterWithWorldSubsystems();
+}
+
+void AEOSTutorialCharacter::OnReleasedToPool()
+{
+	UnregisterFromWorldSubsystems();
+
+	GetWorldTimerManager().ClearTimer(BoneAccuratePoseTimerHandle);
+	EndBoneAccuratePose();
+
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->DisableMovement();
+	ConsumeMovementInputVector();
+	CoalescedMovementInput = FVector2D::ZeroVector;
+	CoalescedLookInput = FVector2D::ZeroVector;
+}
+
+void AEOSTutorialCharacter::NotifyControllerChanged()
+{
+	Super::NotifyControllerChanged();
+	UpdateCameraComponents();
+}
+
+void AEOSTutorialCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(AEOSTutorialCharacter, NetBenchMovementServerTime, COND_SimulatedOnly);
+}
+
+void AEOSTutorialCharacter::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	// Gathers the replicated movement first
+	Super::PreReplication(ChangedPropertyTracker);
+
+	// Only stamped when the movement changed, so the stamp goes out in the same bunch as the movement and costs nothing otherwise
+	if (GetWorld()->GetSubsystem<UEOS_NetBenchSubsystem>() && GetReplicatedMovement() != NetBenchStampedMovement)
+	{
+		NetBenchStampedMovement = GetReplicatedMovement();
+		NetBenchMovementServerTime = GetWorld()->GetTimeSeconds();
+	}
+}
+
+void AEOSTutorialCharacter::PostNetReceiveLocationAndRotation()
+{
+	Super::PostNetReceiveLocationAndRotation();
+
+	// Both times are on the server world clock: the time the server stamped this movement with (every property of the bunch
+	// is applied before the movement is), and our estimate of the current server world time. The game state offsets our clock
+	// by the server time it last received, which was already a one-way trip old, so half our round trip is added back.
+	// Not GetReplicatedServerLastTransformUpdateTimeStamp, that is the owning client's move timestamp when
+	// p.NetUseClientTimestampForReplicatedTransform is on, another clock.
+	UEOS_NetBenchSubsystem* NetBench = GetWorld()->GetSubsystem<UEOS_NetBenchSubsystem>();
+	const AGameStateBase* GameState = GetWorld()->GetGameState();
+	const APlayerController* LocalPlayerController = GetWorld()->GetFirstPlayerController();
+	const APlayerState* LocalPlayerState = LocalPlayerController ? LocalPlayerController->PlayerState.Get() : nullptr;
+	if (NetBench && GameState && LocalPlayerState && GetLocalRole() == ROLE_SimulatedProxy && NetBenchMovementServerTime > 0.0)
+	{
+		const double ServerTime = GameState->GetServerWorldTimeSeconds() + LocalPlayerState->GetPingInMilliseconds() / 2000.0;
+		NetBench->RecordReplicationLatency((ServerTime - NetBenchMovementServerTime) * 1000.0);
+	}
+}
+
+void AEOSTutorialCharacter::UpdateCameraComponents()
+{
+	const bool bIsCameraUsed = IsLocallyControlled() || !IsLeanCharacter();
+	if (CameraBoom)
+	{
+		// The spring arm traces against the world every tick to pull the camera in, only worth it for the camera we look through
+		CameraBoom->bDoCollisionTest = bIsCameraUsed;
+		CameraBoom->SetComponentTickEnabled(bIsCameraUsed);
+	}
+	if (FollowCamera)
+	{
+		FollowCamera->SetActive(bIsCameraUsed);
+	}
+}
+
+void AEOSTutorialCharacter::ApplyControlRigLODThreshold()
+{
+	// The control rig node (CR_Mannequin_Procedural) lives in the post process anim blueprint, found on its generated class
+	GetMesh()->ForEachAnimInstance([this](UAnimInstance* AnimInstance)
+	{
+		for (TFieldIterator<FStructProperty> It(AnimInstance->GetClass()); It; ++It)
+		{
+			if (It->Struct->IsChildOf(FAnimNode_ControlRig::StaticStruct()))
+			{
+				It->ContainerPtrToValuePtr<FAnimNode_ControlRig>(AnimInstance)->LODThreshold = ControlRigLODThreshold;
+			}
+		}
+	});
+}
+
+void AEOSTutorialCharacter::RequestBoneAccuratePose()
+{
+	USkeletalMeshComponent* MeshComponent = GetMesh();
+	if (GetNetMode() != NM_DedicatedServer || !MeshComponent)
+	{
+		return;
+	}
+
+	// Evaluate now for the query, then keep the full pose ticking for the next ones
+	if (MeshComponent->VisibilityBasedAnimTickOption != EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones)
+	{
+		MeshComponent->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::AlwaysTickPoseAndRefreshBones;
+		MeshComponent->TickAnimation(0.f, false);
+		MeshComponent->RefreshBoneTransforms();
+	}
+	GetWorldTimerManager().SetTimer(BoneAccuratePoseTimerHandle, this, &AEOSTutorialCharacter::EndBoneAccuratePose, BoneAccuratePoseDuration);
+}
+
+void AEOSTutorialCharacter::EndBoneAccuratePose()
+{
+	GetMesh()->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickMontagesWhenNotRendered;
+}
+
+// Actor tick time of the world over Frames frames with the characters ticking, then over Frames frames with their ticks off.
+// The difference is what the characters cost the game thread, components the lean setup switched off cost nothing either way.
+static void MeasureCharacterTickTime(UWorld* World, int32 Frames)
+{
+	struct FCharacterTickMeasure
+	{
+		TWeakObjectPtr<UWorld> World;
+		int32 Frames = 0;
+		int32 Frame = 0;
+		int32 NumberOfCharacters = 0;
+		double TickStartTime = 0.0;
+		double TickTimeMs[2] = { 0.0, 0.0 };
+		TArray<TWeakObjectPtr<AActor>> FrozenActors;
+		TArray<TWeakObjectPtr<UActorComponent>> FrozenComponents;
+		FDelegateHandle TickStartHandle;
+		FDelegateHandle PostActorTickHandle;
+	};
+
+	TSharedRef<FCharacterTickMeasure> Measure = MakeShared<FCharacterTickMeasure>();
+	Measure->World = World;
+	Measure->Frames = FMath::Max(Frames, 1);
+	Measure->TickStartHandle = FWorldDelegates::OnWorldTickStart.AddLambda([Measure](UWorld* TickedWorld, ELevelTick, float)
+	{
+		if (TickedWorld == Measure->World.Get())
+		{
+			Measure->TickStartTime = FPlatformTime::Seconds();
+		}
+	});
+	Measure->PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddLambda([Measure](UWorld* TickedWorld, ELevelTick, float)
+	{
+		if (TickedWorld != Measure->World.Get() || Measure->TickStartTime <= 0.0)
+		{
+			return;
+		}
+		Measure->TickTimeMs[Measure->Frame / Measure->Frames] += (FPlatformTime::Seconds() - Measure->TickStartTime) * 1000.0;
+		Measure->Frame++;
+
+		if (Measure->Frame == Measure->Frames)
+		{
+			for (TActorIterator<AEOSTutorialCharacter> It(TickedWorld); It; ++It)
+			{
+				Measure->NumberOfCharacters++;
+				if (It->IsActorTickEnabled())
+				{
+					It->SetActorTickEnabled(false);
+					Measure->FrozenActors.Add(*It);
+				}
+				for (UActorComponent* Component : It->GetComponents())
+				{
+					if (Component->IsComponentTickEnabled())
+					{
+						Component->SetComponentTickEnabled(false);
+						Measure->FrozenComponents.Add(Component);
+					}
+				}
+			}
+		}
+		else if (Measure->Frame == Measure->Frames * 2)
+		{
+			for (const TWeakObjectPtr<AActor>& Actor : Measure->FrozenActors)
+			{
+				if (Actor.IsValid())
+				{
+					Actor->SetActorTickEnabled(true);
+				}
+			}
+			for (const TWeakObjectPtr<UActorComponent>& Component : Measure->FrozenComponents)
+			{
+				if (Component.IsValid())
+				{
+					Component->SetComponentTickEnabled(true);
+				}
+			}
+
+			const double TickingMs = Measure->TickTimeMs[0] / Measure->Frames;
+			const double FrozenMs = Measure->TickTimeMs[1] / Measure->Frames;
+			UE_LOG(LogTemplateCharacter, Log, TEXT("Character tick - %d characters over %d frames: actor tick %.3f ms per frame, %.3f ms with the characters off, %.1f us per character"),
+				Measure->NumberOfCharacters, Measure->Frames, TickingMs, FrozenMs, Measure->NumberOfCharacters > 0 ? (TickingMs - FrozenMs) * 1000.0 / Measure->NumberOfCharacters : 0.0);
+
+			FWorldDelegates::OnWorldTickStart.Remove(Measure->TickStartHandle);
+			FWorldDelegates::OnWorldPostActorTick.Remove(Measure->PostActorTickHandle);
+		}
+	});
+}
+
+// Per pawn footprint, to compare the lean setup of servers and proxies against the locally controlled pawn
+static FAutoConsoleCommandWithWorldAndArgs CharacterFootprintCommand(
+	TEXT("EOS.CharacterFootprint"),
+	TEXT("Log the components, ticking components and memory of every AEOSTutorialCharacter, then their tick time. Run again with -FullCharacter for the baseline. Args : [Frames=120]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		for (TActorIterator<AEOSTutorialCharacter> It(World); It; ++It)
+		{
+			AEOSTutorialCharacter* Character = *It;
+			int32 NumberOfComponents = 0;
+			int32 NumberOfTickingComponents = 0;
+			SIZE_T MemoryBytes = Character->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+			for (UActorComponent* Component : Character->GetComponents())
+			{
+				NumberOfComponents++;
+				NumberOfTickingComponents += Component->IsComponentTickEnabled() ? 1 : 0;
+				MemoryBytes += Component->GetResourceSizeBytes(EResourceSizeMode::Exclusive) + Component->GetClass()->GetStructureSize();
+			}
+			MemoryBytes += Character->GetClass()->GetStructureSize();
+			UE_LOG(LogTemplateCharacter, Log, TEXT("%s - Role %s, Local %d, %d components (%d ticking), %llu bytes"),
+				*Character->GetName(), *UEnum::GetValueAsString(Character->GetLocalRole()), Character->IsLocallyControlled(), NumberOfComponents, NumberOfTickingComponents, (uint64)MemoryBytes);
+		}
+		MeasureCharacterTickTime(World, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 120);
+	}));
+
 //////////////////////////////////////////////////////////////////////////
 // Input
 
@@ -98,17 +454,58 @@ void AEOSTutorialCharacter::Move(const FInputActionValue& Value)
 	// input is a Vector2D
 	FVector2D MovementVector = Value.Get<FVector2D>();
 
+	// Pawn and controller input are sums over the frame anyway, summing first gives the same result for a single update
+	if (bCoalesceInput)
+	{
+		CoalescedMovementInput += MovementVector;
+	}
+	else
+	{
+		ApplyMovementInput(MovementVector);
+	}
+}
+
+void AEOSTutorialCharacter::Look(const FInputActionValue& Value)
+{
+	// input is a Vector2D
+	FVector2D LookAxisVector = Value.Get<FVector2D>();
+
+	if (bCoalesceInput)
+	{
+		CoalescedLookInput += LookAxisVector;
+	}
+	else
+	{
+		ApplyLookInput(LookAxisVector);
+	}
+}
+
+void AEOSTutorialCharacter::FlushCoalescedInput()
+{
+	if (!CoalescedMovementInput.IsZero())
+	{
+		ApplyMovementInput(CoalescedMovementInput);
+		CoalescedMovementInput = FVector2D::ZeroVector;
+	}
+	if (!CoalescedLookInput.IsZero())
+	{
+		ApplyLookInput(CoalescedLookInput);
+		CoalescedLookInput = FVector2D::ZeroVector;
+	}
+}
+
+void AEOSTutorialCharacter::ApplyMovementInput(const FVector2D& MovementVector)
+{
 	if (Controller != nullptr)
 	{
 		// find out which way is forward
 		const FRotator Rotation = Controller->GetControlRotation();
 		const FRotator YawRotation(0, Rotation.Yaw, 0);
 
-		// get forward vector
-		const FVector ForwardDirection = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::X);
-	
-		// get right vector 
-		const FVector RightDirection = FRotationMatrix(YawRotation).GetUnitAxis(EAxis::Y);
+		// get forward and right vectors from a single matrix
+		const FRotationMatrix YawMatrix(YawRotation);
+		const FVector ForwardDirection = YawMatrix.GetUnitAxis(EAxis::X);
+		const FVector RightDirection = YawMatrix.GetUnitAxis(EAxis::Y);
 
 		// add movement 
 		AddMovementInput(ForwardDirection, MovementVector.Y);
@@ -116,15 +513,67 @@ void AEOSTutorialCharacter::Move(const FInputActionValue& Value)
 	}
 }
 
-void AEOSTutorialCharacter::Look(const FInputActionValue& Value)
+void AEOSTutorialCharacter::ApplyLookInput(const FVector2D& LookAxisVector)
 {
-	// input is a Vector2D
-	FVector2D LookAxisVector = Value.Get<FVector2D>();
-
 	if (Controller != nullptr)
 	{
 		// add yaw and pitch input to controller
 		AddControllerYawInput(LookAxisVector.X);
 		AddControllerPitchInput(LookAxisVector.Y);
 	}
+}
+
+void AEOSTutorialCharacter::RunInputBenchmark(UWorld* World, int32 SamplesPerFrame, int32 NumberOfFrames)
+{
+	AEOSTutorialCharacter* Character = nullptr;
+	for (TActorIterator<AEOSTutorialCharacter> It(World); It && !Character; ++It)
+	{
+		Character = It->IsLocallyControlled() ? *It : nullptr;
+	}
+	APlayerController* PlayerController = Character ? Cast<APlayerController>(Character->Controller) : nullptr;
+	if (!PlayerController)
+	{
+		UE_LOG(LogTemplateCharacter, Warning, TEXT("EOS.InputBenchmark needs a locally controlled character !"));
+		return;
+	}
+
+	const bool bWasCoalescingInput = Character->bCoalesceInput;
+	double FrameNs[2];
+	for (int32 Mode = 0; Mode < 2; Mode++)
+	{
+		Character->bCoalesceInput = Mode == 1;
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Frame = 0; Frame < NumberOfFrames; Frame++)
+		{
+			// A high polling rate device delivers many small samples in one frame
+			for (int32 Sample = 0; Sample < SamplesPerFrame; Sample++)
+			{
+				Character->ApplyScriptedInput(FVector2D(0.3f, 1.f), FVector2D(0.01f, -0.005f));
+			}
+			Character->FlushCoalescedInput();
+
+			// Throw the input away, the benchmark must not move or turn the player
+			Character->ConsumeMovementInputVector();
+			PlayerController->RotationInput = FRotator::ZeroRotator;
+		}
+		FrameNs[Mode] = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000000.0 / FMath::Max(NumberOfFrames, 1);
+	}
+	Character->bCoalesceInput = bWasCoalescingInput;
+
+	UE_LOG(LogTemplateCharacter, Log, TEXT("Input benchmark - %d samples per frame, %d frames: one by one %.1f ns per frame, coalesced %.1f ns per frame"),
+		SamplesPerFrame, NumberOfFrames, FrameNs[0], FrameNs[1]);
+}
+
+static FAutoConsoleCommandWithWorldAndArgs InputBenchmarkCommand(
+	TEXT("EOS.InputBenchmark"),
+	TEXT("EOS.InputBenchmark [SamplesPerFrame=8] [Frames=100000] - Per frame cost of move and look input, one by one then coalesced"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		AEOSTutorialCharacter::RunInputBenchmark(World, Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 8, Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 100000);
+	}));
+
+void AEOSTutorialCharacter::ApplyScriptedInput(const FVector2D& MovementVector, const FVector2D& LookAxisVector)
+{
+	Move(FInputActionValue(MovementVector));
+	Look(FInputActionValue(LookAxisVector));
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Character.h"
 #include "Logging/LogMacros.h"
+#include "EOS_ActorPoolSubsystem.h"
 #include "EOSTutorialCharacter.generated.h"
 
 class USpringArmComponent;
@@ -16,15 +17,15 @@ struct FInputActionValue;
 DECLARE_LOG_CATEGORY_EXTERN(LogTemplateCharacter, Log, All);
 
 UCLASS(config=Game)
-class AEOSTutorialCharacter : public ACharacter
+class AEOSTutorialCharacter : public ACharacter, public IEOS_PooledActor
 {
 	GENERATED_BODY()
 
-	/** Camera boom positioning the camera behind the character */
+	/** Camera boom positioning the camera behind the character - Not created on dedicated server */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	USpringArmComponent* CameraBoom;
 
-	/** Follow camera */
+	/** Follow camera - Not created on dedicated server */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	UCameraComponent* FollowCamera;
 	
@@ -44,9 +45,44 @@ class AEOSTutorialCharacter : public ACharacter
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
 	UInputAction* LookAction;
 
+	/** Highest mesh LOD the procedural control rig (foot IK) runs at, distant characters skip it. -1 for every LOD. Written into the Control Rig nodes of every anim instance of the mesh */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Animation, meta = (AllowPrivateAccess = "true"))
+	int32 ControlRigLODThreshold = 0;
+
+	/** Sum every Move / Look sample of a frame and apply them once, in FlushCoalescedInput, instead of one update per sample */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Input, meta = (AllowPrivateAccess = "true"))
+	bool bCoalesceInput = true;
+
+	/** Seconds the dedicated server keeps evaluating the full pose after a bone accurate query asked for it */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Animation, meta = (AllowPrivateAccess = "true"))
+	float BoneAccuratePoseDuration = 1.f;
+
+	/** Net benchmark only - Server world time when the replicated movement last changed, never changes (nor is sent) otherwise */
+	UPROPERTY(Replicated)
+	double NetBenchMovementServerTime = 0.0;
+
+	/** Replicated movement NetBenchMovementServerTime was stamped for */
+	FRepMovement NetBenchStampedMovement;
+
 public:
-	AEOSTutorialCharacter();
+	AEOSTutorialCharacter(const FObjectInitializer& ObjectInitializer);
+
+	/** Names of the optional camera subobjects, skipped with DoNotCreateDefaultSubobject on dedicated server */
+	static FName CameraBoomName;
+	static FName FollowCameraName;
 	
+	/** Feeds scripted input through the same Move / Look path as Enhanced Input, used by headless bots */
+	void ApplyScriptedInput(const FVector2D& MovementVector, const FVector2D& LookAxisVector);
+
+	/** The dedicated server only ticks montages, call before querying bones (hit detection) to get an up to date pose */
+	void RequestBoneAccuratePose();
+
+	/** Apply the input coalesced this frame, called by the player controller once its input is processed */
+	void FlushCoalescedInput();
+
+	/** EOS.InputBenchmark - Per frame cost of SamplesPerFrame move and look samples, one by one then coalesced */
+	static void RunInputBenchmark(UWorld* World, int32 SamplesPerFrame, int32 NumberOfFrames);
+
 
 protected:
 
@@ -55,19 +91,65 @@ protected:
 
 	/** Called for looking input */
 	void Look(const FInputActionValue& Value);
+
+	/** Turn a movement / look vector into pawn and controller input */
+	void ApplyMovementInput(const FVector2D& MovementVector);
+	void ApplyLookInput(const FVector2D& LookAxisVector);
+
+	FVector2D CoalescedMovementInput = FVector2D::ZeroVector;
+	FVector2D CoalescedLookInput = FVector2D::ZeroVector;
 			
 
 protected:
 	// APawn interface
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 	
+	// Lean mesh setup of the dedicated server, before the components register
+	virtual void PreRegisterAllComponents() override;
+
 	// To add mapping context
 	virtual void BeginPlay();
 
+	// Leave the significance manager
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// A match recycle parks the pawn in the actor pool instead of destroying it
+	virtual void Reset() override;
+
+	// IEOS_PooledActor interface
+	virtual void OnAcquiredFromPool() override;
+	virtual void OnReleasedToPool() override;
+
+	/** Join or leave the significance manager and the lag compensation history */
+	void RegisterWithWorldSubsystems();
+	void UnregisterFromWorldSubsystems();
+
+	// Possession changed, the camera may have a new viewer or none
+	virtual void NotifyControllerChanged() override;
+
+	// Stamp changed movement with the server world time, for the net benchmark
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+	// Replicated movement of a simulated character arrived, timed by the net benchmark
+	virtual void PostNetReceiveLocationAndRotation() override;
+
+	/** Write ControlRigLODThreshold into the Control Rig nodes of every anim instance, post process one included. Bound to OnAnimInitialized */
+	UFUNCTION()
+	void ApplyControlRigLODThreshold();
+
+	/** Camera components only tick and trace for the locally controlled pawn, unless -FullCharacter */
+	void UpdateCameraComponents();
+
+	/** Back to montages only once no query needed the pose for BoneAccuratePoseDuration */
+	void EndBoneAccuratePose();
+
+	FTimerHandle BoneAccuratePoseTimerHandle;
+
 public:
-	/** Returns CameraBoom subobject **/
+	/** Returns CameraBoom subobject, null on dedicated server **/
 	FORCEINLINE class USpringArmComponent* GetCameraBoom() const { return CameraBoom; }
-	/** Returns FollowCamera subobject **/
+	/** Returns FollowCamera subobject, null on dedicated server **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
 };
 
@@ -4,7 +4,11 @@
 #include "EOSTutorialCharacter.h"
 #include "UObject/ConstructorHelpers.h"
 #include "EOS_PlayerController.h"
+#include "EOS_PlayerState.h"
 #include "EOS_GameSession.h"
+#include "EOS_ActorPoolSubsystem.h"
+#include "EOS_StartupTrace.h"
+#include "GameFramework/PlayerState.h"
 
 AEOSTutorialGameMode::AEOSTutorialGameMode()
 {
@@ -16,7 +20,52 @@ AEOSTutorialGameMode::AEOSTutorialGameMode()
 	}
 
 	PlayerControllerClass = AEOS_PlayerController::StaticClass(); // Set the PlayerController to our custome one.
+	PlayerStateClass = AEOS_PlayerState::StaticClass(); // Goes back to the actor pool when its player leaves.
 	GameSessionClass = AEOS_GameSession::StaticClass(); // Set the GameDession to our custom one.
 
 	// Network Travel : https://docs.unrealengine.com/4.27/en-US/InteractiveExperiences/Networking/Travelling/
 }
+
+void AEOSTutorialGameMode::PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage)
+{
+	Super::PreLogin(Options, Address, UniqueId, ErrorMessage);
+
+	AEOS_GameSession* EOSGameSession = Cast<AEOS_GameSession>(GameSession);
+	if (ErrorMessage.IsEmpty() && EOSGameSession)
+	{
+		ErrorMessage = EOSGameSession->ApprovePlayer(Options, UniqueId);
+	}
+}
+
+void AEOSTutorialGameMode::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UEOS_ActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UEOS_ActorPoolSubsystem>())
+	{
+		ActorPool->Prewarm(DefaultPawnClass, ActorPool->GetNumberOfPrewarmedActors());
+		ActorPool->Prewarm(PlayerStateClass, ActorPool->GetNumberOfPrewarmedActors());
+	}
+
+	FEOSStartupTrace::Get().MarkPhase(EEOSStartupPhase::BeginPlay);
+}
+
+APawn* AEOSTutorialGameMode::SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform)
+{
+	UEOS_ActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UEOS_ActorPoolSubsystem>();
+	if (!ActorPool)
+	{
+		return Super::SpawnDefaultPawnAtTransform_Implementation(NewPlayer, SpawnTransform);
+	}
+
+	// Same parameters as the base class, only the spawn itself may be skipped
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.Instigator = GetInstigator();
+	SpawnInfo.ObjectFlags |= RF_Transient;
+	APawn* ResultPawn = ActorPool->AcquireActor<APawn>(GetDefaultPawnClassForController(NewPlayer), SpawnTransform, SpawnInfo);
+	if (!ResultPawn)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Couldn't spawn Pawn of type %s at %s !"), *GetNameSafe(GetDefaultPawnClassForController(NewPlayer)), *SpawnTransform.ToHumanReadableString());
+	}
+	return ResultPawn;
+}
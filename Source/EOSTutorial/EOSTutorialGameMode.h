@@ -13,6 +13,16 @@ class AEOSTutorialGameMode : public AGameModeBase
 
 public:
 	AEOSTutorialGameMode();
+
+	// Admission control of the EOS game session, before the player costs a connection, a controller or a pawn
+	virtual void PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage) override;
+
+	// Pawns come out of the dedicated server actor pool when it has one parked
+	virtual APawn* SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform) override;
+
+protected:
+	// Park pawns and player states for the first joins
+	virtual void BeginPlay() override;
 };
 
 
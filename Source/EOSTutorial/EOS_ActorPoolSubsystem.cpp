@@ -0,0 +1,233 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_ActorPoolSubsystem.h"
+#include "Components/ActorComponent.h"
+#include "GameFramework/Actor.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+
+bool UEOS_ActorPoolSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+	// Churn only hurts the server, clients spawn and destroy whatever replication tells them to
+	return Super::ShouldCreateSubsystem(Outer) && IsRunningDedicatedServer();
+}
+
+void UEOS_ActorPoolSubsystem::Deinitialize() {
+	if (Stats.Spawns > 0) {
+		LogStats();
+	}
+	Pools.Empty();
+
+	Super::Deinitialize();
+}
+
+AActor* UEOS_ActorPoolSubsystem::AcquireActor(UClass* Class, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters) {
+	if (!Class) {
+		return nullptr;
+	}
+
+	FEOSActorPoolEntry* Pool = Pools.Find(Class);
+	while (Pool && !Pool->Actors.IsEmpty()) {
+		AActor* Actor = Pool->Actors.Pop(false);
+		if (!IsValid(Actor)) {
+			continue;
+		}
+
+		const double StartTime = FPlatformTime::Seconds();
+		if (!ActivateActor(Actor, Transform, SpawnParameters)) {
+			// A spawn at the same spot would have failed too
+			Pool->Actors.Add(Actor);
+			UE_LOG(LogTemp, Warning, TEXT("Actor pool couldn't place a %s at %s !"), *GetNameSafe(Class), *Transform.GetLocation().ToString());
+			return nullptr;
+		}
+		const double ReuseSeconds = FPlatformTime::Seconds() - StartTime;
+		Stats.ReuseSeconds += ReuseSeconds;
+		Stats.HitchSavedMs += FMath::Max(0.0, Stats.GetAverageSpawnMs() - ReuseSeconds * 1000.0);
+		Stats.Hits++;
+		return Actor;
+	}
+
+	Stats.Misses++;
+	return SpawnActor(Class, Transform, SpawnParameters);
+}
+
+void UEOS_ActorPoolSubsystem::ReleaseActor(AActor* Actor) {
+	if (!IsValid(Actor) || IsPooled(Actor)) {
+		return;
+	}
+
+	FEOSActorPoolEntry& Pool = Pools.FindOrAdd(Actor->GetClass());
+	if (Pool.Actors.Num() >= MaxPooledActorsPerClass) {
+		Stats.Discards++;
+		Actor->Destroy();
+		return;
+	}
+
+	DeactivateActor(Actor);
+	Pool.Actors.Add(Actor);
+	Stats.Releases++;
+}
+
+void UEOS_ActorPoolSubsystem::Prewarm(UClass* Class, int32 Count) {
+	if (!Class) {
+		return;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParameters.ObjectFlags |= RF_Transient;
+
+	const int32 NumberOfActors = FMath::Min(Count, MaxPooledActorsPerClass) - Pools.FindOrAdd(Class).Actors.Num();
+	for (int32 Index = 0; Index < NumberOfActors; Index++) {
+		if (AActor* Actor = SpawnActor(Class, FTransform(ParkingLocation), SpawnParameters)) {
+			DeactivateActor(Actor);
+			Pools.FindOrAdd(Class).Actors.Add(Actor);
+		}
+	}
+}
+
+bool UEOS_ActorPoolSubsystem::IsPooled(const AActor* Actor) const {
+	const FEOSActorPoolEntry* Pool = Actor ? Pools.Find(Actor->GetClass()) : nullptr;
+	return Pool && Pool->Actors.Contains(Actor);
+}
+
+void UEOS_ActorPoolSubsystem::LogStats() const {
+	for (const TPair<TObjectPtr<UClass>, FEOSActorPoolEntry>& Pool : Pools) {
+		UE_LOG(LogTemp, Log, TEXT("Actor pool %s : %d parked"), *GetNameSafe(Pool.Key), Pool.Value.Actors.Num());
+	}
+	UE_LOG(LogTemp, Log, TEXT("Actor pool : %llu hits, %llu misses, %llu releases, %llu discards, spawn %.3f ms, reuse %.3f ms, %.1f ms of hitches saved"),
+		Stats.Hits, Stats.Misses, Stats.Releases, Stats.Discards, Stats.GetAverageSpawnMs(), Stats.GetAverageReuseMs(), Stats.HitchSavedMs);
+}
+
+AActor* UEOS_ActorPoolSubsystem::SpawnActor(UClass* Class, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters) {
+	const double StartTime = FPlatformTime::Seconds();
+	AActor* Actor = GetWorld()->SpawnActor<AActor>(Class, Transform, SpawnParameters);
+	Stats.SpawnSeconds += FPlatformTime::Seconds() - StartTime;
+	Stats.Spawns++;
+
+	if (!Actor) {
+		UE_LOG(LogTemp, Warning, TEXT("Actor pool couldn't spawn a %s !"), *GetNameSafe(Class));
+	}
+	return Actor;
+}
+
+bool UEOS_ActorPoolSubsystem::ActivateActor(AActor* Actor, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters) {
+	// Back to what a freshly spawned actor of the class would have, collision first so the spot can be checked
+	const AActor* DefaultActor = Actor->GetClass()->GetDefaultObject<AActor>();
+	Actor->SetActorTransform(Transform, false, nullptr, ETeleportType::ResetPhysics);
+	Actor->SetActorEnableCollision(DefaultActor->GetActorEnableCollision());
+	if (!ResolveSpawnCollision(Actor, SpawnParameters)) {
+		Actor->SetActorEnableCollision(false);
+		Actor->SetActorLocation(ParkingLocation, false, nullptr, ETeleportType::ResetPhysics);
+		return false;
+	}
+
+	Actor->SetOwner(SpawnParameters.Owner);
+	Actor->SetInstigator(SpawnParameters.Instigator);
+	Actor->SetActorHiddenInGame(DefaultActor->IsHidden());
+	Actor->SetActorTickEnabled(Actor->PrimaryActorTick.bStartWithTickEnabled);
+	for (UActorComponent* Component : Actor->GetComponents()) {
+		if (Component) {
+			Component->SetComponentTickEnabled(Component->PrimaryComponentTick.bStartWithTickEnabled);
+		}
+	}
+
+	// A spawned player state joins the game state and learns whether it is a bot in PostInitializeComponents,
+	// clients add it back once it is active again
+	if (APlayerState* PlayerState = Cast<APlayerState>(Actor)) {
+		PlayerState->Reset();
+		PlayerState->SetIsInactive(false);
+		if (const AController* OwningController = PlayerState->GetOwningController()) {
+			PlayerState->SetIsABot(!OwningController->IsA<APlayerController>());
+		}
+		if (AGameStateBase* GameState = GetWorld()->GetGameState()) {
+			GameState->AddPlayerState(PlayerState);
+		}
+	}
+
+	// Same actor and channel id on clients, the wake up replicates everything that changed while it was parked
+	Actor->SetNetDormancy(DefaultActor->NetDormancy);
+	Actor->ForceNetUpdate();
+
+	if (IEOS_PooledActor* PooledActor = Cast<IEOS_PooledActor>(Actor)) {
+		PooledActor->OnAcquiredFromPool();
+	}
+	return true;
+}
+
+bool UEOS_ActorPoolSubsystem::ResolveSpawnCollision(AActor* Actor, const FActorSpawnParameters& SpawnParameters) const {
+	const ESpawnActorCollisionHandlingMethod CollisionHandlingMethod = SpawnParameters.SpawnCollisionHandlingOverride != ESpawnActorCollisionHandlingMethod::Undefined
+		? SpawnParameters.SpawnCollisionHandlingOverride
+		: Actor->SpawnCollisionHandlingMethod;
+
+	switch (CollisionHandlingMethod) {
+	case ESpawnActorCollisionHandlingMethod::DontSpawnIfColliding:
+		return !GetWorld()->EncroachingBlockingGeometry(Actor, Actor->GetActorLocation(), Actor->GetActorRotation());
+
+	case ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn:
+	case ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding: {
+		// Moved out of whatever it overlaps when there is room nearby, kept as is otherwise
+		FVector AdjustedLocation = Actor->GetActorLocation();
+		FRotator AdjustedRotation = Actor->GetActorRotation();
+		if (GetWorld()->FindTeleportSpot(Actor, AdjustedLocation, AdjustedRotation)) {
+			Actor->SetActorLocationAndRotation(AdjustedLocation, AdjustedRotation, false, nullptr, ETeleportType::ResetPhysics);
+			return true;
+		}
+		return CollisionHandlingMethod == ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	}
+
+	default:
+		return true;
+	}
+}
+
+void UEOS_ActorPoolSubsystem::DeactivateActor(AActor* Actor) {
+	if (IEOS_PooledActor* PooledActor = Cast<IEOS_PooledActor>(Actor)) {
+		PooledActor->OnReleasedToPool();
+	}
+
+	// What APlayerState::Destroyed would have done, then back to the id, name and bot flag of a fresh spawn so nothing
+	// carries over to the next player: the game session gives it an id and the controller a name when it is acquired.
+	// Inactive player states are left out of the player array, on clients too once the flag replicates
+	if (APlayerState* PlayerState = Cast<APlayerState>(Actor)) {
+		if (AGameStateBase* GameState = GetWorld()->GetGameState()) {
+			GameState->RemovePlayerState(PlayerState);
+		}
+		PlayerState->SetUniqueId(FUniqueNetIdRepl());
+		PlayerState->SetPlayerId(0);
+		PlayerState->SetPlayerNameInternal(FString());
+		PlayerState->SetOldPlayerName(FString());
+		PlayerState->SetIsABot(false);
+		PlayerState->SetIsInactive(true);
+	}
+
+	Actor->SetActorHiddenInGame(true);
+	Actor->SetActorEnableCollision(false);
+	Actor->SetActorTickEnabled(false);
+	for (UActorComponent* Component : Actor->GetComponents()) {
+		if (Component) {
+			Component->SetComponentTickEnabled(false);
+		}
+	}
+	Actor->SetOwner(nullptr);
+	Actor->SetInstigator(nullptr);
+	Actor->SetActorLocation(ParkingLocation, false, nullptr, ETeleportType::ResetPhysics);
+
+	// Replicates its parked state one last time then closes its channels, without destroying the clients' copy
+	Actor->ForceNetUpdate();
+	Actor->SetNetDormancy(DORM_DormantAll);
+}
+
+static FAutoConsoleCommandWithWorld ActorPoolStatsCommand(
+	TEXT("EOS.ActorPoolStats"),
+	TEXT("Hits, misses and hitch time saved by the dedicated server actor pool"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World) {
+		if (const UEOS_ActorPoolSubsystem* ActorPool = World ? World->GetSubsystem<UEOS_ActorPoolSubsystem>() : nullptr) {
+			ActorPool->LogStats();
+		}
+		else {
+			UE_LOG(LogTemp, Warning, TEXT("EOS.ActorPoolStats only runs on a dedicated server !"));
+		}
+	})
+);
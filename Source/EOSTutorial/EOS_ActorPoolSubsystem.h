@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/Interface.h"
+#include "Engine/World.h"
+#include "EOS_ActorPoolSubsystem.generated.h"
+
+UINTERFACE(MinimalAPI)
+class UEOS_PooledActor : public UInterface
+{
+	GENERATED_BODY()
+};
+
+/**
+ * Optional hooks of pooled actors, to reset what the pool can't know about
+ */
+class EOSTUTORIAL_API IEOS_PooledActor
+{
+	GENERATED_BODY()
+
+public:
+	// Back in the world, already moved to its spawn transform and replicating again
+	virtual void OnAcquiredFromPool() {}
+
+	// About to be parked, still visible and replicating
+	virtual void OnReleasedToPool() {}
+};
+
+// Actors parked in the pool for one class
+USTRUCT()
+struct FEOSActorPoolEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<TObjectPtr<AActor>> Actors;
+};
+
+// Counters since the server started, prewarmed actors count as spawns but neither as hits nor misses
+struct FEOSActorPoolStats
+{
+	uint64 Hits = 0;
+	uint64 Misses = 0;
+	uint64 Releases = 0;
+	uint64 Discards = 0; // Released while the pool of the class was full, destroyed instead
+
+	uint64 Spawns = 0;
+	double SpawnSeconds = 0.0;
+	double ReuseSeconds = 0.0;
+
+	// What every hit would have cost as a spawn at the time, minus what it cost as a reuse. Only ever grows.
+	// Destructions and their GC are not counted
+	double HitchSavedMs = 0.0;
+
+	double GetAverageSpawnMs() const { return Spawns > 0 ? SpawnSeconds * 1000.0 / Spawns : 0.0; }
+	double GetAverageReuseMs() const { return Hits > 0 ? ReuseSeconds * 1000.0 / Hits : 0.0; }
+};
+
+/**
+ * Dedicated server actor pool - Pawns and player states of leaving players are parked instead of destroyed,
+ * then handed back to the next player instead of spawning new ones. Parked actors are hidden, without collision
+ * or tick, and dormant: clients keep their hidden copy until it wakes up for its next owner. Parked player states
+ * are inactive, so clients take them out of their player array. They stay in the world across match recycles.
+ */
+UCLASS(config=Game)
+class EOSTUTORIAL_API UEOS_ActorPoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Deinitialize() override;
+
+	// A parked actor of Class moved to Transform, or a new one when the pool is empty.
+	// Spawn collision handling applies to both, null when the handling method refuses a colliding spot
+	AActor* AcquireActor(UClass* Class, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters);
+
+	template<typename T>
+	T* AcquireActor(UClass* Class, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters) {
+		return Cast<T>(AcquireActor(Class, Transform, SpawnParameters));
+	}
+
+	// Park Actor for a later AcquireActor, destroys it when the pool of its class is full
+	void ReleaseActor(AActor* Actor);
+
+	// Spawn and park actors until Count of Class are parked, so the first joins don't spawn either
+	void Prewarm(UClass* Class, int32 Count);
+
+	bool IsPooled(const AActor* Actor) const;
+
+	int32 GetNumberOfPrewarmedActors() const { return NumberOfPrewarmedActors; }
+
+	const FEOSActorPoolStats& GetStats() const { return Stats; }
+
+	// One line per class then the totals, for EOS.ActorPoolStats
+	void LogStats() const;
+
+private:
+	AActor* SpawnActor(UClass* Class, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters);
+
+	// False when the spawn collision handling refused the transform, the actor is left parked
+	bool ActivateActor(AActor* Actor, const FTransform& Transform, const FActorSpawnParameters& SpawnParameters);
+
+	// What UWorld::SpawnActor does with the collision handling method of SpawnParameters, or of the actor
+	bool ResolveSpawnCollision(AActor* Actor, const FActorSpawnParameters& SpawnParameters) const;
+	void DeactivateActor(AActor* Actor);
+
+	// Most actors parked per class, more are destroyed
+	UPROPERTY(Config)
+	int32 MaxPooledActorsPerClass = 32;
+
+	// Pawns and player states the game mode parks when play begins
+	UPROPERTY(Config)
+	int32 NumberOfPrewarmedActors = 8;
+
+	// Out of everyone's way, parked actors neither tick nor collide but they still have a location
+	UPROPERTY(Config)
+	FVector ParkingLocation = FVector(0.0, 0.0, -100000.0);
+
+	UPROPERTY()
+	TMap<TObjectPtr<UClass>, FEOSActorPoolEntry> Pools;
+
+	FEOSActorPoolStats Stats;
+};
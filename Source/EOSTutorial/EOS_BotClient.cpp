@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_BotClient.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "OnlineSubsystem.h"
+#include "OnlineSubsystemNames.h"
+#include "Interfaces/OnlineIdentityInterface.h"
+
+const FEOSBotSettings& FEOSBotSettings::Get() {
+	static const FEOSBotSettings Settings = []() {
+		FEOSBotSettings Parsed;
+		const TCHAR* CommandLine = FCommandLine::Get();
+		Parsed.bIsEnabled = FParse::Param(CommandLine, TEXT("EOSBot"));
+		FParse::Value(CommandLine, TEXT("BotId="), Parsed.BotId);
+		FParse::Value(CommandLine, TEXT("BotsPerProcess="), Parsed.BotsPerProcess);
+		Parsed.BotsPerProcess = FMath::Max(Parsed.BotsPerProcess, 1);
+		FParse::Value(CommandLine, TEXT("BotServer="), Parsed.ServerAddress);
+		FParse::Value(CommandLine, TEXT("BotDuration="), Parsed.Duration);
+		FParse::Value(CommandLine, TEXT("BotInputInterval="), Parsed.InputChangeInterval);
+		FParse::Value(CommandLine, TEXT("BotJumpChance="), Parsed.JumpChance);
+		FParse::Value(CommandLine, TEXT("BotStatsInterval="), Parsed.StatsInterval);
+		if (!FParse::Value(CommandLine, TEXT("BotReportDir="), Parsed.ReportDirectory)) {
+			Parsed.ReportDirectory = FPaths::ProjectSavedDir() / TEXT("BotReports");
+		}
+#if !UE_BUILD_SHIPPING
+		Parsed.bAreBotsAllowed = FParse::Param(CommandLine, TEXT("AllowBots"));
+#endif
+		return Parsed;
+	}();
+	return Settings;
+}
+
+FUniqueNetIdPtr FEOSBotSettings::CreateBotUserId(int32 BotId) {
+	IOnlineSubsystem* NullSubsystem = IOnlineSubsystem::Get(NULL_SUBSYSTEM);
+	IOnlineIdentityPtr NullIdentity = NullSubsystem ? NullSubsystem->GetIdentityInterface() : nullptr;
+	if (!NullIdentity) {
+		UE_LOG(LogTemp, Warning, TEXT("Null online subsystem not available, bot %d joins without an id !"), BotId);
+		return nullptr;
+	}
+	return NullIdentity->CreateUniquePlayerId(FString::Printf(TEXT("EOSBot_%d"), BotId));
+}
+
+FEOSBotStats& FEOSBotStats::Get(int32 BotId) {
+	static TMap<int32, FEOSBotStats> Stats;
+	return Stats.FindOrAdd(BotId);
+}
+
+// Average, 95th percentile and maximum of a set of samples, -1 when there is none
+static void Summarize(TArray<float> Samples, float& OutAverage, float& OutP95, float& OutMax) {
+	OutAverage = OutP95 = OutMax = -1.f;
+	if (Samples.Num() == 0) {
+		return;
+	}
+
+	Samples.Sort();
+	float Sum = 0.f;
+	for (float Sample : Samples) {
+		Sum += Sample;
+	}
+	OutAverage = Sum / Samples.Num();
+	OutP95 = Samples[FMath::Min(FMath::FloorToInt(Samples.Num() * 0.95f), Samples.Num() - 1)];
+	OutMax = Samples.Last();
+}
+
+void FEOSBotStats::WriteReport(int32 BotId, const FEOSBotSettings& Settings) const {
+	float RoundTripAverage, RoundTripP95, RoundTripMax;
+	float PingAverage, PingP95, PingMax;
+	float ServerFrameAverage, ServerFrameP95, ServerFrameMax;
+	Summarize(RoundTripTimesMs, RoundTripAverage, RoundTripP95, RoundTripMax);
+	Summarize(PingsMs, PingAverage, PingP95, PingMax);
+	Summarize(ServerFrameTimesMs, ServerFrameAverage, ServerFrameP95, ServerFrameMax);
+
+	UE_LOG(LogTemp, Log, TEXT("Bot %d report - Join %.1f ms, RTT avg %.1f / p95 %.1f / max %.1f ms, Ping avg %.1f ms, Server frame avg %.1f / p95 %.1f / max %.1f ms, %d players max"),
+		BotId, JoinLatencyMs, RoundTripAverage, RoundTripP95, RoundTripMax, PingAverage, ServerFrameAverage, ServerFrameP95, ServerFrameMax, MaxNumberOfServerPlayers);
+
+	// Same header in every file so the reports of a swarm can be concatenated
+	const FString Report = FString::Printf(TEXT("BotId,JoinLatencyMs,RttAvgMs,RttP95Ms,RttMaxMs,PingAvgMs,PingP95Ms,PingMaxMs,ServerFrameAvgMs,ServerFrameP95Ms,ServerFrameMaxMs,MaxServerPlayers,Samples\n%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%d,%d\n"),
+		BotId, JoinLatencyMs, RoundTripAverage, RoundTripP95, RoundTripMax, PingAverage, PingP95, PingMax, ServerFrameAverage, ServerFrameP95, ServerFrameMax, MaxNumberOfServerPlayers, RoundTripTimesMs.Num());
+
+	const FString ReportPath = Settings.ReportDirectory / FString::Printf(TEXT("Bot_%d.csv"), BotId);
+	if (!FFileHelper::SaveStringToFile(Report, *ReportPath)) {
+		UE_LOG(LogTemp, Warning, TEXT("Failed to write bot report to %s !"), *ReportPath);
+	}
+}
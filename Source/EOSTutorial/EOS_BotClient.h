@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Online/CoreOnline.h"
+
+// Command line options of the headless bot mode, used to load test the dedicated server without EOS credentials
+// Example : EOSTutorial ThirdPersonMap -game -nullrhi -nosound -EOSBot -BotId=16 -BotsPerProcess=8 -BotServer=127.0.0.1:7777 -BotDuration=60
+// Every bot of a process is a local player with its own Null id, player controller and pawn on the server.
+// The first one connects, the others join through its connection as splitscreen players (child connections).
+struct FEOSBotSettings {
+	bool bIsEnabled = false; // -EOSBot
+	int32 BotId = 0; // -BotId=, id of the first bot of the process, the others follow. Seeds the input script and names the report
+	int32 BotsPerProcess = 1; // -BotsPerProcess=, the server needs MaxSplitscreensPerConnection at least this high
+	FString ServerAddress = TEXT("127.0.0.1:7777"); // -BotServer=, connected to directly instead of searching sessions
+	float Duration = 60.f; // -BotDuration=, seconds spent in game before reporting and quitting. 0 to never leave.
+	float InputChangeInterval = 2.f; // -BotInputInterval=, seconds between two changes of the scripted input
+	float JumpChance = 0.25f; // -BotJumpChance=, chance to jump every time the input changes
+	float StatsInterval = 1.f; // -BotStatsInterval=, seconds between two round trip / server tick samples
+	FString ReportDirectory; // -BotReportDir=, defaults to Saved/BotReports
+
+	// Server side : -AllowBots, answer the bots' stats RPC. Never in shipping builds.
+	bool bAreBotsAllowed = false;
+
+	// Parsed once from the command line
+	static const FEOSBotSettings& Get();
+
+	// Id standing in for an EOS login, minted by the Null identity interface so the server admits, routes and registers the bot like a player
+	static FUniqueNetIdPtr CreateBotUserId(int32 BotId);
+};
+
+// Measures gathered by one bot, kept for the whole process as they span the travel to the server
+struct FEOSBotStats {
+	double ConnectStartTime = 0.0; // When the bot started connecting to the server
+	float JoinLatencyMs = -1.f; // Connect to possessed pawn, negative until the bot got its pawn
+	TArray<float> RoundTripTimesMs; // Bot RPC sent to the server and answered
+	TArray<float> PingsMs; // Ping the engine measured for our player state
+	TArray<float> ServerFrameTimesMs; // Server frame time when it answered the RPC
+	int32 MaxNumberOfServerPlayers = 0;
+
+	// Stats of one bot of this process, by bot id
+	static FEOSBotStats& Get(int32 BotId);
+
+	// Log a summary and write it as a CSV line (with header) to ReportDirectory/Bot_<BotId>.csv
+	void WriteReport(int32 BotId, const FEOSBotSettings& Settings) const;
+};
@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_CharacterMovementComponent.h"
+#include "EOS_NetBenchSubsystem.h"
+
+// Pending and old moves are a few milliseconds older than the new move, their time stamps share most of its bits
+static void SerializeTimeStampDelta(FArchive& Ar, float& TimeStamp, float ReferenceTimeStamp) {
+	uint32 ReferenceBits;
+	FMemory::Memcpy(&ReferenceBits, &ReferenceTimeStamp, sizeof(uint32));
+
+	uint32 DeltaBits = 0;
+	if (Ar.IsSaving()) {
+		FMemory::Memcpy(&DeltaBits, &TimeStamp, sizeof(uint32));
+		DeltaBits ^= ReferenceBits;
+	}
+
+	uint32 NumberOfBits = 32 - FMath::CountLeadingZeros(DeltaBits);
+	Ar.SerializeInt(NumberOfBits, 33);
+	if (NumberOfBits > 0) {
+		Ar.SerializeBits(&DeltaBits, NumberOfBits);
+	}
+
+	if (Ar.IsLoading()) {
+		DeltaBits ^= ReferenceBits;
+		FMemory::Memcpy(&TimeStamp, &DeltaBits, sizeof(uint32));
+	}
+}
+
+// One bit when the value is the default one
+template<typename T>
+static void SerializeOptionalValue(FArchive& Ar, T& Value, const T& DefaultValue) {
+	uint8 bIsDefault = Ar.IsSaving() && Value == DefaultValue;
+	Ar.SerializeBits(&bIsDefault, 1);
+	if (!bIsDefault) {
+		Ar << Value;
+	}
+	else if (Ar.IsLoading()) {
+		Value = DefaultValue;
+	}
+}
+
+bool FEOSCharacterNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) {
+	NetworkMoveType = MoveType;
+	const bool bIsNewMove = MoveType == ENetworkMoveType::NewMove || !ReferenceMove;
+
+	if (bIsNewMove) {
+		Ar << TimeStamp;
+	}
+	else {
+		SerializeTimeStampDelta(Ar, TimeStamp, ReferenceMove->TimeStamp);
+	}
+
+	// Input rarely changes between consecutive moves
+	uint8 bSameInput = !bIsNewMove && Ar.IsSaving() && Acceleration == ReferenceMove->Acceleration && ControlRotation == ReferenceMove->ControlRotation;
+	if (!bIsNewMove) {
+		Ar.SerializeBits(&bSameInput, 1);
+	}
+	if (bSameInput) {
+		if (Ar.IsLoading()) {
+			Acceleration = ReferenceMove->Acceleration;
+			ControlRotation = ReferenceMove->ControlRotation;
+		}
+	}
+	else {
+		SerializeAcceleration(Ar, PackageMap, CharacterMovement.GetMaxAcceleration());
+		SerializeControlRotation(Ar);
+	}
+
+	SerializeOptionalValue<uint8>(Ar, CompressedMoveFlags, 0);
+
+	// Location, movement base and movement mode are only checked against the new move
+	if (bIsNewMove) {
+		bool bLocationSuccess = true;
+		FVector_NetQuantize10 QuantizedLocation = Location;
+		QuantizedLocation.NetSerialize(Ar, PackageMap, bLocationSuccess);
+		Location = QuantizedLocation;
+
+		UObject* MovementBaseObject = MovementBase;
+		SerializeOptionalValue<UObject*>(Ar, MovementBaseObject, nullptr);
+		MovementBase = Cast<UPrimitiveComponent>(MovementBaseObject);
+		SerializeOptionalValue<FName>(Ar, MovementBaseBoneName, NAME_None);
+		SerializeOptionalValue<uint8>(Ar, MovementMode, MOVE_Walking);
+	}
+	else if (Ar.IsLoading()) {
+		Location = ReferenceMove->Location;
+		MovementBase = ReferenceMove->MovementBase;
+		MovementBaseBoneName = ReferenceMove->MovementBaseBoneName;
+		MovementMode = ReferenceMove->MovementMode;
+	}
+
+	return !Ar.IsError();
+}
+
+void FEOSCharacterNetworkMoveData::SerializeAcceleration(FArchive& Ar, UPackageMap* PackageMap, float MaxAcceleration) {
+	uint8 bIsZero = Ar.IsSaving() && Acceleration.IsZero();
+	Ar.SerializeBits(&bIsZero, 1);
+	if (bIsZero) {
+		if (Ar.IsLoading()) {
+			Acceleration = FVector::ZeroVector;
+		}
+		return;
+	}
+
+	// Walking and falling characters only accelerate in the XY plane, anything else goes at full precision
+	uint16 Yaw = 0;
+	uint8 Magnitude = 0;
+	uint8 bIsPlanar = Ar.IsSaving() && UEOS_CharacterMovementComponent::QuantizePlanarAcceleration(Acceleration, MaxAcceleration, Yaw, Magnitude);
+	Ar.SerializeBits(&bIsPlanar, 1);
+	if (bIsPlanar) {
+		Ar.SerializeBits(&Yaw, UEOS_CharacterMovementComponent::AccelerationYawBits);
+		Ar.SerializeBits(&Magnitude, UEOS_CharacterMovementComponent::AccelerationMagnitudeBits);
+		if (Ar.IsLoading()) {
+			Acceleration = UEOS_CharacterMovementComponent::DequantizePlanarAcceleration(Yaw, Magnitude, MaxAcceleration);
+		}
+	}
+	else {
+		bool bSuccess = true;
+		Acceleration.NetSerialize(Ar, PackageMap, bSuccess);
+	}
+}
+
+void FEOSCharacterNetworkMoveData::SerializeControlRotation(FArchive& Ar) {
+	uint16 Yaw = FRotator::CompressAxisToShort(ControlRotation.Yaw) >> (16 - UEOS_CharacterMovementComponent::ControlYawBits);
+	uint16 Pitch = FRotator::CompressAxisToShort(ControlRotation.Pitch) >> (16 - UEOS_CharacterMovementComponent::ControlPitchBits);
+	Ar.SerializeBits(&Yaw, UEOS_CharacterMovementComponent::ControlYawBits);
+	Ar.SerializeBits(&Pitch, UEOS_CharacterMovementComponent::ControlPitchBits);
+
+	// The controller of this character never rolls, keep a bit for the rare case it does
+	uint8 Roll = FRotator::CompressAxisToByte(ControlRotation.Roll);
+	SerializeOptionalValue<uint8>(Ar, Roll, 0);
+
+	if (Ar.IsLoading()) {
+		ControlRotation.Yaw = FRotator::DecompressAxisFromShort(Yaw << (16 - UEOS_CharacterMovementComponent::ControlYawBits));
+		ControlRotation.Pitch = FRotator::DecompressAxisFromShort(Pitch << (16 - UEOS_CharacterMovementComponent::ControlPitchBits));
+		ControlRotation.Roll = FRotator::DecompressAxisFromByte(Roll);
+	}
+}
+
+FEOSCharacterNetworkMoveDataContainer::FEOSCharacterNetworkMoveDataContainer() {
+	NewMoveData = &EOSMoveData[0];
+	PendingMoveData = &EOSMoveData[1];
+	OldMoveData = &EOSMoveData[2];
+	EOSMoveData[1].ReferenceMove = &EOSMoveData[0];
+	EOSMoveData[2].ReferenceMove = &EOSMoveData[0];
+}
+
+bool FEOSCharacterNetworkMoveDataContainer::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap) {
+	if (!NewMoveData->Serialize(CharacterMovement, Ar, PackageMap, FCharacterNetworkMoveData::ENetworkMoveType::NewMove)) {
+		return false;
+	}
+
+	Ar.SerializeBits(&bDisableCombinedScopedMove, 1);
+
+	Ar.SerializeBits(&bHasPendingMove, 1);
+	if (bHasPendingMove) {
+		Ar.SerializeBits(&bIsDualHybridRootMotionMove, 1);
+		if (!PendingMoveData->Serialize(CharacterMovement, Ar, PackageMap, FCharacterNetworkMoveData::ENetworkMoveType::PendingMove)) {
+			return false;
+		}
+	}
+
+	Ar.SerializeBits(&bHasOldMove, 1);
+	if (bHasOldMove) {
+		if (!OldMoveData->Serialize(CharacterMovement, Ar, PackageMap, FCharacterNetworkMoveData::ENetworkMoveType::OldMove)) {
+			return false;
+		}
+	}
+
+	return !Ar.IsError();
+}
+
+UEOS_CharacterMovementComponent::UEOS_CharacterMovementComponent() {
+	SetNetworkMoveDataContainer(EOSMoveDataContainer);
+}
+
+FVector UEOS_CharacterMovementComponent::RoundAcceleration(FVector InAccel) const {
+	// Only the planar acceleration is quantized, anything else is sent at full precision and rounded as usual
+	uint16 Yaw;
+	uint8 Magnitude;
+	if (InAccel.IsZero() || !QuantizePlanarAcceleration(InAccel, GetMaxAcceleration(), Yaw, Magnitude)) {
+		return Super::RoundAcceleration(InAccel);
+	}
+	return DequantizePlanarAcceleration(Yaw, Magnitude, GetMaxAcceleration());
+}
+
+void UEOS_CharacterMovementComponent::OnClientCorrectionReceived(FNetworkPredictionData_Client_Character& ClientData, float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode) {
+	Super::OnClientCorrectionReceived(ClientData, TimeStamp, NewLocation, NewVelocity, NewBase, NewBaseBoneName, bHasBase, bBaseRelativePosition, ServerMovementMode);
+
+	if (UEOS_NetBenchSubsystem* NetBench = GetWorld()->GetSubsystem<UEOS_NetBenchSubsystem>()) {
+		NetBench->RecordCorrection();
+	}
+}
+
+bool UEOS_CharacterMovementComponent::QuantizePlanarAcceleration(const FVector& Acceleration, float MaxAcceleration, uint16& OutYaw, uint8& OutMagnitude) {
+	if (MaxAcceleration <= 0.f || !FMath::IsNearlyZero(Acceleration.Z)) {
+		return false;
+	}
+
+	constexpr int32 YawSteps = 1 << AccelerationYawBits;
+	constexpr int32 MaxMagnitude = (1 << AccelerationMagnitudeBits) - 1;
+	const double Yaw = FMath::Atan2(Acceleration.Y, Acceleration.X);
+	OutYaw = (uint16)(FMath::RoundToInt(Yaw / UE_DOUBLE_TWO_PI * YawSteps) & (YawSteps - 1));
+	OutMagnitude = (uint8)FMath::Clamp(FMath::RoundToInt(Acceleration.Size2D() / MaxAcceleration * MaxMagnitude), 0, MaxMagnitude);
+	return true;
+}
+
+FVector UEOS_CharacterMovementComponent::DequantizePlanarAcceleration(uint16 Yaw, uint8 Magnitude, float MaxAcceleration) {
+	constexpr int32 YawSteps = 1 << AccelerationYawBits;
+	constexpr int32 MaxMagnitude = (1 << AccelerationMagnitudeBits) - 1;
+	const double Angle = Yaw * UE_DOUBLE_TWO_PI / YawSteps;
+	const double Size = (double)Magnitude * MaxAcceleration / MaxMagnitude;
+	return FVector(FMath::Cos(Angle) * Size, FMath::Sin(Angle) * Size, 0.0);
+}
+
+FVector UEOS_CharacterMovementComponent::QuantizeAcceleration(const FVector& Acceleration, float MaxAcceleration) {
+	uint16 Yaw;
+	uint8 Magnitude;
+	if (Acceleration.IsZero() || !QuantizePlanarAcceleration(Acceleration, MaxAcceleration, Yaw, Magnitude)) {
+		return Acceleration;
+	}
+	return DequantizePlanarAcceleration(Yaw, Magnitude, MaxAcceleration);
+}
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "EOS_CharacterMovementComponent.generated.h"
+
+/**
+ * Move data sent in ServerMovePacked - Inputs are quantized to a few bits: planar acceleration as a direction
+ * and a fraction of MaxAcceleration, control rotation on 12/10 bits. Pending and old moves ride in the same RPC
+ * as the new move and are delta encoded against it, mostly a bit per field when the input did not change.
+ */
+struct FEOSCharacterNetworkMoveData : public FCharacterNetworkMoveData
+{
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+
+	// New move of the same RPC, null for the new move itself
+	const FEOSCharacterNetworkMoveData* ReferenceMove = nullptr;
+
+private:
+	void SerializeAcceleration(FArchive& Ar, UPackageMap* PackageMap, float MaxAcceleration);
+	void SerializeControlRotation(FArchive& Ar);
+};
+
+struct FEOSCharacterNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+	FEOSCharacterNetworkMoveDataContainer();
+
+	// Always the new move first, pending and old moves are decoded against it
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap) override;
+
+private:
+	FEOSCharacterNetworkMoveData EOSMoveData[3];
+};
+
+/**
+ * Character movement with quantized, delta encoded moves sent to the server.
+ */
+UCLASS()
+class EOSTUTORIAL_API UEOS_CharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	UEOS_CharacterMovementComponent();
+
+	// The acceleration the server will decode, saved moves simulate with it so quantization never causes a correction
+	virtual FVector RoundAcceleration(FVector InAccel) const override;
+
+	// Counted by the net benchmark
+	virtual void OnClientCorrectionReceived(class FNetworkPredictionData_Client_Character& ClientData, float TimeStamp, FVector NewLocation, FVector NewVelocity, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode) override;
+
+	// Acceleration in the XY plane as a yaw and a fraction of MaxAcceleration, false when it does not fit
+	static bool QuantizePlanarAcceleration(const FVector& Acceleration, float MaxAcceleration, uint16& OutYaw, uint8& OutMagnitude);
+	static FVector DequantizePlanarAcceleration(uint16 Yaw, uint8 Magnitude, float MaxAcceleration);
+
+	// What the server decodes from Acceleration
+	static FVector QuantizeAcceleration(const FVector& Acceleration, float MaxAcceleration);
+
+	static constexpr int32 AccelerationYawBits = 10;
+	static constexpr int32 AccelerationMagnitudeBits = 7;
+	static constexpr int32 ControlYawBits = 12;
+	static constexpr int32 ControlPitchBits = 10;
+
+private:
+	FEOSCharacterNetworkMoveDataContainer EOSMoveDataContainer;
+};
@@ -0,0 +1,16 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_DemoNetDriver.h"
+#include "EOS_TelemetrySubsystem.h"
+#include "Engine/World.h"
+
+void UEOS_DemoNetDriver::TickFlush(float DeltaSeconds) {
+	const double StartTime = FPlatformTime::Seconds();
+	Super::TickFlush(DeltaSeconds);
+
+	UEOS_TelemetrySubsystem* Telemetry = World ? World->GetSubsystem<UEOS_TelemetrySubsystem>() : nullptr;
+	if (Telemetry && IsRecording()) {
+		Telemetry->RecordReplayTick((FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+}
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DemoNetDriver.h"
+#include "EOS_DemoNetDriver.generated.h"
+
+/**
+ * Demo net driver recording the server replays - Same as the engine one, but times every recording frame
+ * and hands it to the telemetry subsystem, which reports it against the world tick.
+ */
+UCLASS(transient, config=Engine)
+class EOSTUTORIAL_API UEOS_DemoNetDriver : public UDemoNetDriver
+{
+	GENERATED_BODY()
+
+public:
+	virtual void TickFlush(float DeltaSeconds) override;
+};
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_FleetAgentSubsystem.h"
+#include "EOS_GameSession.h"
+#include "EOS_StartupTrace.h"
+#include "EOS_TelemetrySubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+
+bool UEOS_FleetAgentSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+	// Servers started by hand have no allocator to talk to
+	FString Directory;
+	return Super::ShouldCreateSubsystem(Outer) && IsRunningDedicatedServer() && FParse::Value(FCommandLine::Get(), TEXT("FleetDir="), Directory);
+}
+
+void UEOS_FleetAgentSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	FParse::Value(FCommandLine::Get(), TEXT("FleetDir="), FleetDirectory);
+	StartTime = FPlatformTime::Seconds();
+}
+
+TStatId UEOS_FleetAgentSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEOS_FleetAgentSubsystem, STATGROUP_Tickables);
+}
+
+void UEOS_FleetAgentSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	// A hung world stops writing, which is how the allocator notices it
+	const double Now = FPlatformTime::Seconds();
+	if (Now < NextStatusTime || FleetDirectory.IsEmpty()) {
+		return;
+	}
+	NextStatusTime = Now + StatusInterval;
+
+	ApplyCommands();
+	WriteStatus();
+
+	// A drained server leaves once its last player is gone, the allocator doesn't restart it
+	const AEOS_GameSession* GameSession = GetWorld()->GetAuthGameMode() ? Cast<AEOS_GameSession>(GetWorld()->GetAuthGameMode()->GameSession) : nullptr;
+	if (GameSession && GameSession->IsDraining() && GetWorld()->GetAuthGameMode()->GetNumPlayers() == 0) {
+		UE_LOG(LogTemp, Log, TEXT("Server drained, exiting !"));
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void UEOS_FleetAgentSubsystem::ApplyCommands() {
+	const FString CommandPath = FleetDirectory / FString::Printf(TEXT("Server_%d.command"), GetWorld()->URL.Port);
+	FString Commands;
+	if (!FFileHelper::LoadFileToString(Commands, *CommandPath) || Commands == LastCommands) {
+		return;
+	}
+
+	AEOS_GameSession* GameSession = GetWorld()->GetAuthGameMode() ? Cast<AEOS_GameSession>(GetWorld()->GetAuthGameMode()->GameSession) : nullptr;
+	if (!GameSession) {
+		return;
+	}
+	LastCommands = Commands;
+
+	// One key=value per line, every line is optional
+	int32 bAdvertise = 1;
+	if (FParse::Value(*Commands, TEXT("advertise="), bAdvertise)) {
+		GameSession->SetAcceptingNewMatches(bAdvertise != 0);
+	}
+	int32 bDrain = 0;
+	if (FParse::Value(*Commands, TEXT("drain="), bDrain) && bDrain != 0 && !GameSession->IsDraining()) {
+		UE_LOG(LogTemp, Log, TEXT("Fleet allocator asked to drain this server !"));
+		GameSession->StartDraining();
+	}
+}
+
+void UEOS_FleetAgentSubsystem::WriteStatus() {
+	UWorld* World = GetWorld();
+	const AGameModeBase* GameMode = World->GetAuthGameMode();
+	const AEOS_GameSession* GameSession = GameMode ? Cast<AEOS_GameSession>(GameMode->GameSession) : nullptr;
+	const UEOS_TelemetrySubsystem* Telemetry = World->GetSubsystem<UEOS_TelemetrySubsystem>();
+
+	// Plain key=value lines, read by the allocator with sed
+	FString Status;
+	Status += FString::Printf(TEXT("port=%d\npid=%u\nuptime=%.0f\n"), World->URL.Port, FPlatformProcess::GetCurrentProcessId(), FPlatformTime::Seconds() - StartTime);
+	Status += FString::Printf(TEXT("players=%d\n"), GameMode ? GameMode->GetNumPlayers() : 0);
+	Status += FString::Printf(TEXT("rss_mb=%.0f\n"), FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0));
+	if (GameSession) {
+		Status += FString::Printf(TEXT("capacity=%d\nopen_slots=%d\nadvertise=%d\ndraining=%d\n"),
+			GameSession->GetCapacity(), GameSession->GetNumberOfOpenSlots(), GameSession->IsAcceptingNewMatches() ? 1 : 0, GameSession->IsDraining() ? 1 : 0);
+	}
+	if (Telemetry) {
+		Status += FString::Printf(TEXT("world_tick_ms=%.2f\n"), Telemetry->GetAverageWorldTickMs());
+	}
+	if (FEOSStartupTrace::Get().GetStartupSeconds() > 0.0) {
+		Status += FString::Printf(TEXT("startup_ms=%.0f\n"), FEOSStartupTrace::Get().GetStartupSeconds() * 1000.0);
+	}
+
+	// Written next to the status then moved over it, the allocator never reads half a file
+	const FString Path = FleetDirectory / FString::Printf(TEXT("Server_%d.status"), World->URL.Port);
+	const FString TemporaryPath = Path + TEXT(".tmp");
+	if (!FFileHelper::SaveStringToFile(Status, *TemporaryPath) || !IFileManager::Get().Move(*Path, *TemporaryPath, true)) {
+		UE_LOG(LogTemp, Warning, TEXT("Failed to write fleet status to %s !"), *Path);
+	}
+}
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EOS_FleetAgentSubsystem.generated.h"
+
+/**
+ * Dedicated server side of the local fleet allocator (Fleet.sh) - Only created with -FleetDir=.
+ * Once a second, rewrites <FleetDir>/Server_<Port>.status with the health and load of this process, and applies
+ * <FleetDir>/Server_<Port>.command, where the allocator tells it whether to open new matches or to drain and quit.
+ */
+UCLASS(config=Game)
+class EOSTUTORIAL_API UEOS_FleetAgentSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	void ApplyCommands();
+	void WriteStatus();
+
+	// Seconds between two status files, the allocator considers a server hung after a few missed ones
+	UPROPERTY(Config)
+	float StatusInterval = 1.f;
+
+	FString FleetDirectory;
+	FString LastCommands; // Content of the command file last applied
+
+	double NextStatusTime = 0.0;
+	double StartTime = 0.0;
+};
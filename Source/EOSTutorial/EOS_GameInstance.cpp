@@ -8,6 +8,98 @@
 #include "Online/OnlineSessionNames.h"
 #include "Interfaces/OnlineIdentityInterface.h"
 #include "Kismet/GameplayStatics.h"
+#include "TimerManager.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "EOS_StartupTrace.h"
+#include "EOS_NetBenchSubsystem.h"
+#include "EOS_GameSession.h"
+
+void UEOS_GameInstance::Init()
+{
+	Super::Init();
+
+	// Before the server listens or a bot connects
+	UEOS_NetBenchSubsystem::ApplyTransport();
+
+	// The engine loads the map right after this, whatever is already requested doesn't wait for it
+	if (IsDedicatedServerInstance()) {
+		FEOSStartupTrace::Get().BeginStartup();
+		FEOSStartupTrace::Get().MarkPhase(EEOSStartupPhase::GameInstanceInit);
+		PreloadServerMap();
+	}
+}
+
+void UEOS_GameInstance::LoadComplete(const float LoadTime, const FString& MapName)
+{
+	Super::LoadComplete(LoadTime, MapName);
+
+	// The server map holds its own references now
+	if (IsDedicatedServerInstance()) {
+		FEOSStartupTrace::Get().MarkPhase(EEOSStartupPhase::MapLoaded);
+		ReleasePreloadedAssets();
+	}
+}
+
+void UEOS_GameInstance::Shutdown()
+{
+	// Unbind from the session interface before the online subsystem goes away
+	if (SessionOperations) {
+		SessionOperations->Shutdown();
+	}
+
+	Super::Shutdown();
+}
+
+void UEOS_GameInstance::PreloadServerMap()
+{
+	if (PreloadHandle.IsValid()) {
+		return;
+	}
+
+	TArray<FSoftObjectPath> AssetsToLoad = PreloadedAssets;
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+	const UWorld* World = GetWorld();
+	for (const FString& MapPackageName : PreloadedMaps) {
+		// Holding the world we are on would leak it through the map change, hold what it is made of instead
+		if (World && World->GetOutermost()->GetName() == MapPackageName) {
+			TArray<FName> Dependencies;
+			AssetRegistry.GetDependencies(FName(*MapPackageName), Dependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+			for (const FName& Dependency : Dependencies) {
+				TArray<FAssetData> Assets;
+				AssetRegistry.GetAssetsByPackageName(Dependency, Assets);
+				for (const FAssetData& Asset : Assets) {
+					AssetsToLoad.AddUnique(Asset.GetSoftObjectPath());
+				}
+			}
+		}
+		else {
+			const FString MapName = FPackageName::GetShortName(MapPackageName);
+			AssetsToLoad.AddUnique(FSoftObjectPath(FString::Printf(TEXT("%s.%s"), *MapPackageName, *MapName)));
+		}
+	}
+
+	if (AssetsToLoad.Num() == 0) {
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Preloading %d assets for the server map..."), AssetsToLoad.Num());
+	PreloadStartTime = FPlatformTime::Seconds();
+	const int32 NumberOfAssets = AssetsToLoad.Num();
+	PreloadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(MoveTemp(AssetsToLoad), FStreamableDelegate::CreateWeakLambda(this, [this, NumberOfAssets]() {
+		UE_LOG(LogTemp, Log, TEXT("Preloaded %d assets in %.1f ms"), NumberOfAssets, (FPlatformTime::Seconds() - PreloadStartTime) * 1000.0);
+		FEOSStartupTrace::Get().MarkPhase(EEOSStartupPhase::PreloadCompleted);
+	}), FStreamableManager::AsyncLoadHighPriority);
+}
+
+void UEOS_GameInstance::ReleasePreloadedAssets()
+{
+	if (PreloadHandle.IsValid()) {
+		PreloadHandle->ReleaseHandle();
+		PreloadHandle.Reset();
+	}
+}
 
 void UEOS_GameInstance::LoginWithEOS(FString ID, FString Token, FString LoginType)
 {
@@ -73,21 +165,36 @@ void UEOS_GameInstance::CreateEOSSession(bool bIsDedicatedServer, bool bIsLanSer
 	}
 }
 
-void UEOS_GameInstance::FindSessionAndJoin()
+// Session with the most free slots, the lowest ping between equals. INDEX_NONE when every session is full
+static int32 FindBestSearchResult(const TArray<FOnlineSessionSearchResult>& SearchResults)
 {
-	IOnlineSubsystem* SubsystemRef = Online::GetSubsystem(this->GetWorld());
-	if (SubsystemRef) {
-		IOnlineSessionPtr SessionPtrRef = SubsystemRef->GetSessionInterface();
-		if (SessionPtrRef) {
-			SessionSearch = MakeShareable(new FOnlineSessionSearch());
-			SessionSearch->QuerySettings.Set(SEARCH_LOBBIES, true, EOnlineComparisonOp::Equals);
-			SessionSearch->bIsLanQuery = false;
-			SessionSearch->MaxSearchResults = 20;
-			SessionSearch->QuerySettings.SearchParams.Empty();
-			SessionPtrRef->OnFindSessionsCompleteDelegates.AddUObject(this, &UEOS_GameInstance::OnFindSessionCompleted);
-			SessionPtrRef->FindSessions(0, SessionSearch.ToSharedRef());
+	int32 BestIndex = INDEX_NONE;
+	for (int32 Index = 0; Index < SearchResults.Num(); ++Index) {
+		const FOnlineSessionSearchResult& SearchResult = SearchResults[Index];
+		if (SearchResult.Session.NumOpenPublicConnections <= 0) {
+			continue;
 		}
+		const FOnlineSessionSearchResult* BestSearchResult = BestIndex != INDEX_NONE ? &SearchResults[BestIndex] : nullptr;
+		if (!BestSearchResult || SearchResult.Session.NumOpenPublicConnections > BestSearchResult->Session.NumOpenPublicConnections
+			|| (SearchResult.Session.NumOpenPublicConnections == BestSearchResult->Session.NumOpenPublicConnections && SearchResult.PingInMs < BestSearchResult->PingInMs)) {
+			BestIndex = Index;
+		}
+	}
+	return BestIndex;
+}
+
+void UEOS_GameInstance::FindSessionAndJoin()
+{
+	// Join straight from the cache when it has something, the result is validated first
+	TArray<FOnlineSessionSearchResult> CachedSearchResults = GetCachedSearchResults();
+	const int32 BestIndex = FindBestSearchResult(CachedSearchResults);
+	if (BestIndex != INDEX_NONE) {
+		ValidateSearchResult(CachedSearchResults[BestIndex], FOnEOSSearchResultValidated::CreateUObject(this, &UEOS_GameInstance::OnCachedSessionValidated));
+		return;
 	}
+
+	// Unfiltered search
+	SearchSessions({ FEOSSessionSearchKey() }, FOnEOSSessionSearchCompleted::CreateUObject(this, &UEOS_GameInstance::OnFindSessionCompleted));
 }
 
 void UEOS_GameInstance::JoinSession()
@@ -127,46 +234,245 @@ void UEOS_GameInstance::OnDestroySessionCompleted(FName SessionName, bool bWasSu
 {
 }
 
-void UEOS_GameInstance::OnFindSessionCompleted(bool bWasSuccessful)
+void UEOS_GameInstance::OnFindSessionCompleted(const TArray<FOnlineSessionSearchResult>& SearchResults)
 {
-	if (bWasSuccessful) {
-		IOnlineSubsystem* SubsystemRef = Online::GetSubsystem(this->GetWorld());
-		if (SubsystemRef) {
-			IOnlineSessionPtr SessionPtrRef = SubsystemRef->GetSessionInterface();
-			if (SessionPtrRef) {
-				if (SessionSearch->SearchResults.Num() > 0) {
-					SessionPtrRef->OnJoinSessionCompleteDelegates.AddUObject(this, &UEOS_GameInstance::OnJoinSessionCompleted);
-					SessionPtrRef->JoinSession(0, FName("MainSession"), SessionSearch->SearchResults[0]);
-				}
-				else {
-					UE_LOG(LogTemp, Error, TEXT("Server Not Found"));
-					//CreateEOSSession(false, false, 10);
-				}
+	IOnlineSubsystem* SubsystemRef = Online::GetSubsystem(this->GetWorld());
+	if (SubsystemRef) {
+		IOnlineSessionPtr SessionPtrRef = SubsystemRef->GetSessionInterface();
+		if (SessionPtrRef) {
+			const int32 BestIndex = FindBestSearchResult(SearchResults);
+			if (BestIndex != INDEX_NONE) {
+				// One binding per join, removed once it answered
+				SessionPtrRef->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionDelegateHandle);
+				JoinSessionDelegateHandle = SessionPtrRef->AddOnJoinSessionCompleteDelegate_Handle(FOnJoinSessionCompleteDelegate::CreateUObject(this, &UEOS_GameInstance::OnJoinSessionCompleted));
+				SessionPtrRef->JoinSession(0, FName("MainSession"), SearchResults[BestIndex]);
+			}
+			else {
+				UE_LOG(LogTemp, Error, TEXT("Server Not Found"));
+				//CreateEOSSession(false, false, 10);
 			}
 		}
 	}
+}
+
+void UEOS_GameInstance::OnCachedSessionValidated(bool bIsStillJoinable, const FOnlineSessionSearchResult& SearchResult)
+{
+	if (bIsStillJoinable) {
+		OnFindSessionCompleted({ SearchResult });
+	}
 	else {
-		UE_LOG(LogTemp, Error, TEXT("Server Not Found"));
-		//CreateEOSSession(false, false, 10);
+		// The stale result has been dropped from the cache, try the next one or search again
+		FindSessionAndJoin();
 	}
 }
 
 void UEOS_GameInstance::OnJoinSessionCompleted(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
 {
-	if (Result == EOnJoinSessionCompleteResult::Success) {
+	IOnlineSubsystem* SubsystemRef = Online::GetSubsystem(this->GetWorld());
+	IOnlineSessionPtr SessionPtrRef = SubsystemRef ? SubsystemRef->GetSessionInterface() : nullptr;
+	if (SessionPtrRef) {
+		SessionPtrRef->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionDelegateHandle);
+	}
+	JoinSessionDelegateHandle.Reset();
+
+	if (Result == EOnJoinSessionCompleteResult::Success && SessionPtrRef) {
 		if (APlayerController* PlayerControllerRef = UGameplayStatics::GetPlayerController(GetWorld(), 0)) {
+			// Like AEOS_PlayerController, servers sharing a machine advertise their own address and port, the resolved
+			// connect string is used otherwise, and the server is told which of its hosted sessions we joined
 			FString JoinAddress;
-			IOnlineSubsystem* SubsystemRef = Online::GetSubsystem(this->GetWorld());
-			if (SubsystemRef) {
-				IOnlineSessionPtr SessionPtrRef = SubsystemRef->GetSessionInterface();
-				if (SessionPtrRef) {
-					SessionPtrRef->GetResolvedConnectString(FName("MainSession"), JoinAddress);
-					UE_LOG(LogTemp, Warning, TEXT("Joining Address : %s"), *JoinAddress);
-					if (!JoinAddress.IsEmpty()) {
-						PlayerControllerRef->ClientTravel(JoinAddress, ETravelType::TRAVEL_Absolute);
-					}
-				}
+			FString HostedSessionName;
+			FNamedOnlineSession* JoinedSession = SessionPtrRef->GetNamedSession(FName("MainSession"));
+			if (!JoinedSession || !JoinedSession->SessionSettings.Get(SETTING_SERVERADDRESS, JoinAddress) || JoinAddress.IsEmpty()) {
+				SessionPtrRef->GetResolvedConnectString(FName("MainSession"), JoinAddress);
+			}
+			if (!JoinAddress.IsEmpty() && JoinedSession && JoinedSession->SessionSettings.Get(SETTING_HOSTEDSESSION, HostedSessionName)) {
+				JoinAddress += FString::Printf(TEXT("?%s=%s"), *SETTING_HOSTEDSESSION.ToString(), *HostedSessionName);
+			}
+			UE_LOG(LogTemp, Warning, TEXT("Joining Address : %s"), *JoinAddress);
+			if (!JoinAddress.IsEmpty()) {
+				PlayerControllerRef->ClientTravel(JoinAddress, ETravelType::TRAVEL_Absolute);
+			}
+		}
+	}
+}
+
+TSharedPtr<FEOSSessionOperations> UEOS_GameInstance::GetSessionOperations()
+{
+	if (!SessionOperations) {
+		IOnlineSubsystem* SubsystemRef = Online::GetSubsystem(this->GetWorld());
+		if (SubsystemRef && SubsystemRef->GetSessionInterface()) {
+			SessionOperations = MakeShared<FEOSSessionOperations>(SubsystemRef->GetSessionInterface());
+		}
+	}
+	return SessionOperations;
+}
+
+TSharedRef<FOnlineSessionSearch> UEOS_GameInstance::MakeSessionSearch(const FEOSSessionSearchKey& SearchKey) const
+{
+	TSharedRef<FOnlineSessionSearch> Search = MakeShared<FOnlineSessionSearch>();
+	Search->bIsLanQuery = false;
+	Search->MaxSearchResults = MaxSearchResults;
+
+	// Remove the default settings that FOnlineSessionSearch set
+	Search->QuerySettings.SearchParams.Empty();
+
+	// Search using key/value attributes
+	if (!SearchKey.Key.IsNone()) {
+		Search->QuerySettings.Set(SearchKey.Key, SearchKey.Value, EOnlineComparisonOp::Equals);
+	}
+	return Search;
+}
+
+void UEOS_GameInstance::SearchSessions(const TArray<FEOSSessionSearchKey>& SearchKeys, const FOnEOSSessionSearchCompleted& OnCompleted)
+{
+	TSharedPtr<FEOSSessionOperations> Operations = GetSessionOperations();
+	if (!Operations || SearchKeys.Num() == 0) {
+		OnCompleted.ExecuteIfBound(TArray<FOnlineSessionSearchResult>());
+		return;
+	}
+
+	// Remember the keys so the background refresh keeps their results warm
+	for (const FEOSSessionSearchKey& SearchKey : SearchKeys) {
+		SearchCacheKeys.AddUnique(SearchKey);
+	}
+	if (!GetTimerManager().IsTimerActive(SearchCacheRefreshTimerHandle)) {
+		GetTimerManager().SetTimer(SearchCacheRefreshTimerHandle, this, &UEOS_GameInstance::RefreshSearchCache, SearchCacheRefreshInterval, true);
+	}
+
+	TSharedRef<FEOSPendingSessionSearch> PendingSearch = MakeShared<FEOSPendingSessionSearch>();
+	PendingSearch->NumberOfPendingSearches = SearchKeys.Num();
+	PendingSearch->OnCompleted = OnCompleted;
+
+	UE_LOG(LogTemp, Log, TEXT("Finding sessions with %d search key(s)..."), SearchKeys.Num());
+
+	// The OSS only runs one search at a time, the operation queue sends them back to back
+	for (const FEOSSessionSearchKey& SearchKey : SearchKeys) {
+		TSharedRef<FOnlineSessionSearch> Search = MakeSessionSearch(SearchKey);
+		Operations->FindSessions(0, Search, FOnEOSSessionOperationCompleted::CreateUObject(this, &UEOS_GameInstance::HandleSearchCompleted, Search, SearchKey, PendingSearch));
+	}
+}
+
+void UEOS_GameInstance::HandleSearchCompleted(EEOSSessionOperationResult Result, TSharedRef<FOnlineSessionSearch> Search, FEOSSessionSearchKey SearchKey, TSharedRef<FEOSPendingSessionSearch> PendingSearch)
+{
+	if (Result == EEOSSessionOperationResult::Success) {
+		UE_LOG(LogTemp, Log, TEXT("Found %d sessions !"), Search->SearchResults.Num());
+		UpdateSearchCache(SearchKey, Search->SearchResults);
+
+		// Several keys can match the same session, keep it once
+		for (const FOnlineSessionSearchResult& SearchResult : Search->SearchResults) {
+			const FString SessionId = SearchResult.GetSessionIdStr();
+			if (!PendingSearch->SearchResults.ContainsByPredicate([&SessionId](const FOnlineSessionSearchResult& MergedResult) { return MergedResult.GetSessionIdStr() == SessionId; })) {
+				PendingSearch->SearchResults.Add(SearchResult);
 			}
 		}
 	}
+	else {
+		UE_LOG(LogTemp, Warning, TEXT("Failed to find session ! (From Callback)"));
+	}
+
+	// Wait for every search before answering
+	if (--PendingSearch->NumberOfPendingSearches == 0) {
+		PendingSearch->OnCompleted.ExecuteIfBound(PendingSearch->SearchResults);
+	}
+}
+
+void UEOS_GameInstance::UpdateSearchCache(const FEOSSessionSearchKey& SearchKey, const TArray<FOnlineSessionSearchResult>& SearchResults)
+{
+	// Sessions this search found last time but not anymore are gone or full
+	for (auto CachedSearchResult = SearchCache.CreateIterator(); CachedSearchResult; ++CachedSearchResult) {
+		if (CachedSearchResult.Value().SearchKey == SearchKey) {
+			CachedSearchResult.RemoveCurrent();
+		}
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	for (const FOnlineSessionSearchResult& SearchResult : SearchResults) {
+		FEOSCachedSearchResult& CachedSearchResult = SearchCache.FindOrAdd(SearchResult.GetSessionIdStr());
+		CachedSearchResult.SearchResult = SearchResult;
+		CachedSearchResult.SearchKey = SearchKey;
+		CachedSearchResult.CachedTime = Now;
+	}
+}
+
+TArray<FOnlineSessionSearchResult> UEOS_GameInstance::GetCachedSearchResults() const
+{
+	TArray<FOnlineSessionSearchResult> CachedSearchResults;
+	const double Now = FPlatformTime::Seconds();
+	for (const TPair<FString, FEOSCachedSearchResult>& CachedSearchResult : SearchCache) {
+		if (Now - CachedSearchResult.Value.CachedTime < SearchCacheTimeToLive) {
+			CachedSearchResults.Add(CachedSearchResult.Value.SearchResult);
+		}
+	}
+	return CachedSearchResults;
+}
+
+void UEOS_GameInstance::RefreshSearchCache()
+{
+	// Drop what is too old to be served anyway
+	const double Now = FPlatformTime::Seconds();
+	for (auto CachedSearchResult = SearchCache.CreateIterator(); CachedSearchResult; ++CachedSearchResult) {
+		if (Now - CachedSearchResult.Value().CachedTime >= SearchCacheTimeToLive) {
+			CachedSearchResult.RemoveCurrent();
+		}
+	}
+
+	TSharedPtr<FEOSSessionOperations> Operations = GetSessionOperations();
+	if (!Operations || bIsRefreshingSearchCache || SearchCacheKeys.Num() == 0) {
+		return;
+	}
+
+	const FEOSSessionSearchKey SearchKey = SearchCacheKeys[NextRefreshedSearchKey++ % SearchCacheKeys.Num()];
+	TSharedRef<FOnlineSessionSearch> Search = MakeSessionSearch(SearchKey);
+	bIsRefreshingSearchCache = true;
+	Operations->FindSessions(0, Search, FOnEOSSessionOperationCompleted::CreateUObject(this, &UEOS_GameInstance::HandleSearchCacheRefreshed, Search, SearchKey));
+}
+
+void UEOS_GameInstance::HandleSearchCacheRefreshed(EEOSSessionOperationResult Result, TSharedRef<FOnlineSessionSearch> Search, FEOSSessionSearchKey SearchKey)
+{
+	bIsRefreshingSearchCache = false;
+	if (Result == EEOSSessionOperationResult::Success) {
+		UpdateSearchCache(SearchKey, Search->SearchResults);
+	}
+}
+
+void UEOS_GameInstance::StopSearchCacheRefresh()
+{
+	GetTimerManager().ClearTimer(SearchCacheRefreshTimerHandle);
+	SearchCacheKeys.Reset();
+	NextRefreshedSearchKey = 0;
+}
+
+void UEOS_GameInstance::ValidateSearchResult(const FOnlineSessionSearchResult& SearchResult, const FOnEOSSearchResultValidated& OnValidated)
+{
+	IOnlineSubsystem* SubsystemRef = Online::GetSubsystem(this->GetWorld());
+	IOnlineIdentityPtr IdentityPointerRef = SubsystemRef ? SubsystemRef->GetIdentityInterface() : nullptr;
+	FUniqueNetIdPtr UserId = IdentityPointerRef ? IdentityPointerRef->GetUniquePlayerId(0) : nullptr;
+	TSharedPtr<FEOSSessionOperations> Operations = GetSessionOperations();
+
+	// Can't validate without a logged in user, let the join itself tell if the session is still there
+	if (!Operations || !UserId || !SearchResult.Session.SessionInfo.IsValid()) {
+		OnValidated.ExecuteIfBound(true, SearchResult);
+		return;
+	}
+
+	TSharedRef<FOnlineSessionSearchResult> UpToDateSearchResult = MakeShared<FOnlineSessionSearchResult>(SearchResult);
+	Operations->FindSessionById(*UserId, SearchResult.Session.SessionInfo->GetSessionId(), UpToDateSearchResult,
+		FOnEOSSessionOperationCompleted::CreateUObject(this, &UEOS_GameInstance::HandleSearchResultValidated, UpToDateSearchResult, SearchResult.GetSessionIdStr(), OnValidated));
+}
+
+void UEOS_GameInstance::HandleSearchResultValidated(EEOSSessionOperationResult Result, TSharedRef<FOnlineSessionSearchResult> SearchResult, FString SessionId, FOnEOSSearchResultValidated OnValidated)
+{
+	const bool bIsStillJoinable = Result == EEOSSessionOperationResult::Success && SearchResult->Session.NumOpenPublicConnections > 0;
+	if (bIsStillJoinable) {
+		if (FEOSCachedSearchResult* CachedSearchResult = SearchCache.Find(SessionId)) {
+			CachedSearchResult->SearchResult = *SearchResult;
+			CachedSearchResult->CachedTime = FPlatformTime::Seconds();
+		}
+	}
+	else {
+		UE_LOG(LogTemp, Log, TEXT("Cached session %s is not joinable anymore"), *SessionId);
+		SearchCache.Remove(SessionId);
+	}
+
+	OnValidated.ExecuteIfBound(bIsStillJoinable, *SearchResult);
 }
@@ -5,8 +5,46 @@
 #include "CoreMinimal.h"
 #include "Engine/GameInstance.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "OnlineSessionSettings.h"
+#include "EOS_SessionOperations.h"
 #include "EOS_GameInstance.generated.h"
 
+struct FStreamableHandle;
+
+// One key/value attribute to search sessions with - Every key is searched and the results are merged. No filter if Key is None.
+USTRUCT()
+struct FEOSSessionSearchKey
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FName Key;
+
+	UPROPERTY()
+	FString Value;
+
+	bool operator==(const FEOSSessionSearchKey& Other) const { return Key == Other.Key && Value == Other.Value; }
+};
+
+DECLARE_DELEGATE_OneParam(FOnEOSSessionSearchCompleted, const TArray<FOnlineSessionSearchResult>& /*SearchResults*/);
+DECLARE_DELEGATE_TwoParams(FOnEOSSearchResultValidated, bool /*bIsStillJoinable*/, const FOnlineSessionSearchResult& /*UpToDateSearchResult*/);
+
+// A search result kept in the session search cache
+struct FEOSCachedSearchResult
+{
+	FOnlineSessionSearchResult SearchResult;
+	FEOSSessionSearchKey SearchKey; // Search that found it, refreshing this search drops the result if it isn't found anymore
+	double CachedTime = 0.0;
+};
+
+// Searches started by a single SearchSessions call
+struct FEOSPendingSessionSearch
+{
+	int32 NumberOfPendingSearches = 0;
+	TArray<FOnlineSessionSearchResult> SearchResults;
+	FOnEOSSessionSearchCompleted OnCompleted;
+};
+
 /**
  * 
  */
@@ -16,6 +54,30 @@ class EOSTUTORIAL_API UEOS_GameInstance : public UGameInstance
 	GENERATED_BODY()
 
 public:
+	virtual void Init() override;
+	virtual void LoadComplete(const float LoadTime, const FString& MapName) override;
+	virtual void Shutdown() override;
+
+	// Start loading what the server map needs in the background, while login and session search run
+	void PreloadServerMap();
+
+	// The server map is loaded and holds its own references, stop keeping the preloaded assets alive
+	void ReleasePreloadedAssets();
+
+	// Session operation queue shared by everything on this client, so searches and joins never overlap on the OSS
+	TSharedPtr<FEOSSessionOperations> GetSessionOperations();
+
+	// Full search of every key. Results are merged, cached and given back once every search is done.
+	void SearchSessions(const TArray<FEOSSessionSearchKey>& SearchKeys, const FOnEOSSessionSearchCompleted& OnCompleted);
+
+	// Cached results still within their time to live - Served right away, validate them before joining
+	TArray<FOnlineSessionSearchResult> GetCachedSearchResults() const;
+
+	// Fetch the up to date state of a cached session. Not joinable anymore sessions are dropped from the cache.
+	void ValidateSearchResult(const FOnlineSessionSearchResult& SearchResult, const FOnEOSSearchResultValidated& OnValidated);
+
+	// No need to keep the cache warm once we are in a match
+	void StopSearchCacheRefresh();
 
 	UFUNCTION(BlueprintCallable, Category = "EOS Functions")
 	void LoginWithEOS(FString ID, FString Token, FString LoginType);
@@ -38,14 +100,58 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "EOS Functions")
 	void DestroySession();
 
-	TSharedPtr<FOnlineSessionSearch> SessionSearch;
-
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="EOS Variables")
 	FString OpenLevelText;
 
 	void LoginWithEOS_Return(int32 LocalUserNum, bool bWasSuccessful, const FUniqueNetId& UserID, const FString& Error);
 	void OnCreateSessionCompleted(FName SessionName, bool bWasSuccessful);
 	void OnDestroySessionCompleted(FName SessionName, bool bWasSuccessful);
-	void OnFindSessionCompleted(bool bWasSuccessful);
+	void OnFindSessionCompleted(const TArray<FOnlineSessionSearchResult>& SearchResults);
+	void OnCachedSessionValidated(bool bIsStillJoinable, const FOnlineSessionSearchResult& SearchResult);
 	void OnJoinSessionCompleted(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
+
+private:
+	TSharedRef<FOnlineSessionSearch> MakeSessionSearch(const FEOSSessionSearchKey& SearchKey) const;
+
+	// Replace the cached results of a search with its latest results
+	void UpdateSearchCache(const FEOSSessionSearchKey& SearchKey, const TArray<FOnlineSessionSearchResult>& SearchResults);
+
+	// Refresh one search key per call, round robin, so the backend sees a trickle of queries instead of bursts
+	void RefreshSearchCache();
+
+	void HandleSearchCompleted(EEOSSessionOperationResult Result, TSharedRef<FOnlineSessionSearch> Search, FEOSSessionSearchKey SearchKey, TSharedRef<FEOSPendingSessionSearch> PendingSearch);
+	void HandleSearchCacheRefreshed(EEOSSessionOperationResult Result, TSharedRef<FOnlineSessionSearch> Search, FEOSSessionSearchKey SearchKey);
+	void HandleSearchResultValidated(EEOSSessionOperationResult Result, TSharedRef<FOnlineSessionSearchResult> SearchResult, FString SessionId, FOnEOSSearchResultValidated OnValidated);
+
+	TSharedPtr<FEOSSessionOperations> SessionOperations;
+
+	FDelegateHandle JoinSessionDelegateHandle; // Bound for the join in progress only
+
+	TMap<FString, FEOSCachedSearchResult> SearchCache; // Cached search results, by session id
+	TArray<FEOSSessionSearchKey> SearchCacheKeys; // Every key searched so far, kept warm by the background refresh
+	int32 NextRefreshedSearchKey = 0;
+	bool bIsRefreshingSearchCache = false;
+	FTimerHandle SearchCacheRefreshTimerHandle;
+
+	// Seconds a search result is served from the cache
+	UPROPERTY(Config)
+	float SearchCacheTimeToLive = 30.f;
+
+	// Seconds between two background searches. Each one refreshes a single key.
+	UPROPERTY(Config)
+	float SearchCacheRefreshInterval = 5.f;
+
+	UPROPERTY(Config)
+	int32 MaxSearchResults = 20;
+
+	// Maps we are going to travel to, or a dedicated server starts on. The map itself is preloaded, or only its dependencies when it is the map we are on.
+	UPROPERTY(Config)
+	TArray<FString> PreloadedMaps;
+
+	// Other assets spawned once on the server map, like the player character. Requested after the maps, in this order, so every start loads the same way
+	UPROPERTY(Config)
+	TArray<FSoftObjectPath> PreloadedAssets;
+
+	TSharedPtr<FStreamableHandle> PreloadHandle; // Keeps the preloaded assets alive through the map change
+	double PreloadStartTime = 0.0;
 };
\ No newline at end of file
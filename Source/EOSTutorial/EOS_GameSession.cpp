@@ -11,12 +11,32 @@
 #include "Interfaces/OnlineIdentityInterface.h"
 #include "Interfaces/OnlineStatsInterface.h"
 #include "GameFramework/PlayerState.h"
+#include "TimerManager.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/GameModeBase.h"
+#include "EOS_TelemetrySubsystem.h"
+#include "Engine/GameInstance.h"
+#include "Engine/NetDriver.h"
+#include "Kismet/GameplayStatics.h"
+#include "EOS_StartupTrace.h"
+#include "EOS_ServerStreamingSubsystem.h"
 
 void AEOS_GameSession::BeginPlay() {
 	Super::BeginPlay();
-	// Only create a session if running as a dedicated server and session doesn't exist
-	if (IsRunningDedicatedServer() && !bSessionExists) {
-		CreateSession("KeyName", "KeyValue");
+	// Only create sessions if running as a dedicated server and they don't exist
+	if (IsRunningDedicatedServer() && HostedSessions.Num() == 0) {
+		FEOSSessionOperationPolicy Policy;
+		Policy.Timeout = SessionOperationTimeout;
+		Policy.MaxRetries = SessionOperationMaxRetries;
+		Policy.RetryDelay = SessionOperationRetryDelay;
+		SessionOperations = MakeShared<FEOSSessionOperations>(Online::GetSubsystem(GetWorld())->GetSessionInterface(), Policy);
+
+		// The base ApproveLogin turns players away past MaxPlayers, make it the sum of every hosted session
+		MaxPlayers = GetCapacity();
+
+		FParse::Value(FCommandLine::Get(), TEXT("PublicAddress="), PublicAddress);
+
+		MaintainSessionPool();
 	}
 }
 
@@ -25,198 +45,582 @@ bool AEOS_GameSession::ProcessAutoLogin() {
 	return true;
 }
 
+void AEOS_GameSession::MaintainSessionPool() {
+	// Backing off after failed creates, the timer maintains the pool once the delay elapsed
+	if (!IsRunningDedicatedServer() || bIsShuttingDown || bIsDraining || GetWorldTimerManager().IsTimerActive(SessionPoolBackoffTimerHandle)) {
+		return;
+	}
+
+	int32 NumberOfEmptySessions = 0;
+	for (const TPair<FName, FEOSHostedSession>& HostedSession : HostedSessions) {
+		const EEOSSessionState State = HostedSession.Value.State;
+		if ((State == EEOSSessionState::Creating || State == EEOSSessionState::Pending) && HostedSession.Value.NumberOfRoutedPlayers == 0) {
+			NumberOfEmptySessions++;
+		}
+	}
+
+	const int32 NumberOfWantedStandbySessions = bIsAcceptingNewMatches ? NumberOfStandbySessions : 0;
+	while (NumberOfEmptySessions < NumberOfWantedStandbySessions && HostedSessions.Num() < NumberOfSessions) {
+		CreateSession(FName(*FString::Printf(TEXT("%s_%d"), *SessionNamePrefix, NextSessionIndex++)), "KeyName", "KeyValue");
+		NumberOfEmptySessions++;
+	}
+}
+
+void AEOS_GameSession::RecycleSession(FName HostedSessionName) {
+	// The world is shared by every hosted session, its reset waits for the last player of any match to leave
+	bIsLevelResetPending = true;
+	ResetLevelIfEmpty(nullptr);
+
+	UE_LOG(LogTemp, Log, TEXT("Recycling session %s..."), *HostedSessionName.ToString());
+	DestroySession(HostedSessionName); // A fresh session is created by the pool once this one is destroyed
+}
+
+bool AEOS_GameSession::IsWorldEmpty(const APlayerController* ExitingPlayer) const {
+	for (const TPair<FName, FEOSHostedSession>& HostedSession : HostedSessions) {
+		if (HostedSession.Value.NumberOfRoutedPlayers > 0) {
+			return false;
+		}
+	}
+
+	// Players never routed to a session, like bots, still have a pawn in the world
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It) {
+		if (It->Get() && It->Get() != ExitingPlayer) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void AEOS_GameSession::ResetLevelIfEmpty(const APlayerController* ExitingPlayer) {
+	AGameModeBase* GameMode = GetWorld()->GetAuthGameMode();
+	if (!bIsLevelResetPending || !GameMode || !IsWorldEmpty(ExitingPlayer)) {
+		return;
+	}
+
+	bIsLevelResetPending = false;
+	UE_LOG(LogTemp, Log, TEXT("Every match is over, resetting the level..."));
+	GameMode->ResetLevel();
+}
+
+void AEOS_GameSession::SetSessionState(FEOSHostedSession& HostedSession, EEOSSessionState State) {
+	HostedSession.State = State;
+	if (UEOS_TelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UEOS_TelemetrySubsystem>()) {
+		Telemetry->RecordSessionState(HostedSession.SessionName, State);
+	}
+}
+
+// Returns true if PlayerId is part of Players
+static bool ContainsPlayer(const TArray<FUniqueNetIdRef>& Players, const FUniqueNetId& PlayerId) {
+	return Players.ContainsByPredicate([&PlayerId](const FUniqueNetIdRef& Player) { return *Player == PlayerId; });
+}
+
+// Clients joined a specific EOS session and pass its name in their travel URL. Players without it fill the most populated open session.
+FName AEOS_GameSession::RouteNewPlayer(FName RequestedSessionName, const FUniqueNetIdRepl& UniqueId) const {
+	// A player coming back, or admitted before its login, goes where its slot was kept
+	if (UniqueId.IsValid()) {
+		for (const TPair<FName, FEOSHostedSession>& HostedSession : HostedSessions) {
+			if (HostedSession.Value.Reservations.Contains(UniqueId) && CanSessionTakePlayer(HostedSession.Value, UniqueId)) {
+				return HostedSession.Key;
+			}
+		}
+	}
+
+	const FEOSHostedSession* RequestedSession = HostedSessions.Find(RequestedSessionName);
+	if (RequestedSession && CanSessionTakePlayer(*RequestedSession, UniqueId)) {
+		return RequestedSessionName;
+	}
+
+	const FEOSHostedSession* BestSession = nullptr;
+	for (const TPair<FName, FEOSHostedSession>& HostedSession : HostedSessions) {
+		const FEOSHostedSession& Candidate = HostedSession.Value;
+		if (CanSessionTakePlayer(Candidate, UniqueId) && (!BestSession || Candidate.NumberOfRoutedPlayers > BestSession->NumberOfRoutedPlayers)) {
+			BestSession = &Candidate;
+		}
+	}
+	return BestSession ? BestSession->SessionName : NAME_None;
+}
+
+// Slots held for players other than ExcludedPlayer
+static int32 GetNumberOfReservedSlots(const FEOSHostedSession& HostedSession, const FUniqueNetIdRepl& ExcludedPlayer, double Now) {
+	int32 NumberOfReservedSlots = 0;
+	for (const TPair<FUniqueNetIdRepl, double>& Reservation : HostedSession.Reservations) {
+		if (Reservation.Value > Now && Reservation.Key != ExcludedPlayer) {
+			NumberOfReservedSlots++;
+		}
+	}
+	return NumberOfReservedSlots;
+}
+
+bool AEOS_GameSession::CanSessionTakePlayer(const FEOSHostedSession& HostedSession, const FUniqueNetIdRepl& UniqueId) const {
+	const double Now = FPlatformTime::Seconds();
+	const double* ReservationEndTime = UniqueId.IsValid() ? HostedSession.Reservations.Find(UniqueId) : nullptr;
+	const bool bHasReservation = ReservationEndTime && *ReservationEndTime > Now;
+
+	// Started matches only take their own players back, unless they allow joining in progress
+	const bool bIsStarted = HostedSession.State == EEOSSessionState::Starting || HostedSession.State == EEOSSessionState::InProgress;
+	if (HostedSession.State != EEOSSessionState::Pending && !(bIsStarted && (bAllowJoinInProgress || bHasReservation))) {
+		return false;
+	}
+
+	return HostedSession.NumberOfRoutedPlayers + GetNumberOfReservedSlots(HostedSession, UniqueId, Now) < MaxNumberOfPlayersInSession;
+}
+
+int32 AEOS_GameSession::GetNumberOfOpenSlots() const {
+	if (bIsDraining) {
+		return 0;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	int32 NumberOfOpenSlots = 0;
+	for (const TPair<FName, FEOSHostedSession>& HostedSession : HostedSessions) {
+		if (CanSessionTakePlayer(HostedSession.Value, FUniqueNetIdRepl())) {
+			NumberOfOpenSlots += MaxNumberOfPlayersInSession - HostedSession.Value.NumberOfRoutedPlayers - GetNumberOfReservedSlots(HostedSession.Value, FUniqueNetIdRepl(), Now);
+		}
+	}
+	if (bIsAcceptingNewMatches) {
+		NumberOfOpenSlots += FMath::Max(NumberOfSessions - HostedSessions.Num(), 0) * MaxNumberOfPlayersInSession;
+	}
+	return NumberOfOpenSlots;
+}
+
+void AEOS_GameSession::SetAcceptingNewMatches(bool bAccept) {
+	if (bIsAcceptingNewMatches != bAccept) {
+		bIsAcceptingNewMatches = bAccept;
+		UE_LOG(LogTemp, Log, TEXT("%s new matches"), bAccept ? TEXT("Accepting") : TEXT("No longer accepting"));
+		MaintainSessionPool();
+	}
+}
+
+void AEOS_GameSession::StartDraining() {
+	bIsDraining = true;
+
+	// Nobody can find them anymore, matches in progress go on until their players leave
+	TArray<FName> EmptySessionNames;
+	for (const TPair<FName, FEOSHostedSession>& HostedSession : HostedSessions) {
+		if (HostedSession.Value.State == EEOSSessionState::Pending && HostedSession.Value.NumberOfRoutedPlayers == 0 && HostedSession.Value.Reservations.IsEmpty()) {
+			EmptySessionNames.Add(HostedSession.Key);
+		}
+	}
+	for (const FName& HostedSessionName : EmptySessionNames) {
+		DestroySession(HostedSessionName);
+	}
+}
+
+bool AEOS_GameSession::HasTickBudgetHeadroom() const {
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	const UEOS_TelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UEOS_TelemetrySubsystem>();
+	if (!NetDriver || !Telemetry || NetDriver->GetNetServerMaxTickRate() <= 0) {
+		return true;
+	}
+
+	const float FrameBudgetMs = 1000.f / NetDriver->GetNetServerMaxTickRate();
+	return Telemetry->GetAverageWorldTickMs() <= FrameBudgetMs * (1.f - MinTickBudgetHeadroom);
+}
+
+void AEOS_GameSession::RemoveExpiredReservations() {
+	const double Now = FPlatformTime::Seconds();
+	for (TPair<FName, FEOSHostedSession>& HostedSession : HostedSessions) {
+		for (auto It = HostedSession.Value.Reservations.CreateIterator(); It; ++It) {
+			if (It->Value <= Now) {
+				It.RemoveCurrent();
+			}
+		}
+	}
+}
+
+bool AEOS_GameSession::CanRegisterInSession(const FUniqueNetIdRepl& UniqueId) const {
+	const IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
+	return UniqueId.IsValid() && Subsystem && UniqueId.GetType() == Subsystem->GetSubsystemName();
+}
+
+bool AEOS_GameSession::IsPlayerConnectedTo(FName HostedSessionName, const FUniqueNetId& PlayerId) const {
+	for (const TPair<const APlayerController*, FName>& PlayerSession : PlayerSessions) {
+		if (PlayerSession.Value == HostedSessionName && PlayerSession.Key->PlayerState && PlayerSession.Key->PlayerState->GetUniqueId().IsValid() && *PlayerSession.Key->PlayerState->GetUniqueId() == PlayerId) {
+			return true;
+		}
+	}
+	return false;
+}
+
+FString AEOS_GameSession::ApprovePlayer(const FString& Options, const FUniqueNetIdRepl& UniqueId) {
+	if (!IsRunningDedicatedServer()) {
+		return FString();
+	}
+
+	RemoveExpiredReservations();
+	const FName RequestedSessionName = FName(UGameplayStatics::ParseOption(Options, SETTING_HOSTEDSESSION.ToString()));
+	const FName HostedSessionName = RouteNewPlayer(RequestedSessionName, UniqueId);
+	const FEOSHostedSession* HostedSession = HostedSessions.Find(HostedSessionName);
+	const bool bCanRegister = CanRegisterInSession(UniqueId);
+	const bool bHasReservation = HostedSession && bCanRegister && HostedSession->Reservations.Contains(UniqueId);
+
+	// A player holding a reservation was already part of the load, only new players need headroom
+	const UEOS_ServerStreamingSubsystem* ServerStreaming = GetWorld()->GetSubsystem<UEOS_ServerStreamingSubsystem>();
+	const TCHAR* Rejection = nullptr;
+	FString ErrorMessage;
+	if (!bHasReservation && bIsDraining) {
+		Rejection = TEXT("Draining");
+		ErrorMessage = TEXT("Server is shutting down.");
+	}
+	else if (!bHasReservation && !HasTickBudgetHeadroom()) {
+		Rejection = TEXT("Busy");
+		ErrorMessage = TEXT("Server is busy, try again later.");
+	}
+	// Every new player streams more of the world in, over the hard cap even players coming back would
+	else if (ServerStreaming && (ServerStreaming->IsOverHardMemoryCap() || (!bHasReservation && ServerStreaming->IsOverSoftMemoryCap()))) {
+		Rejection = TEXT("Memory");
+		ErrorMessage = TEXT("Server is busy, try again later.");
+	}
+	// Players without an id the sessions can register are never registered in a hosted session
+	else if (!HostedSession && bCanRegister) {
+		const FEOSHostedSession* RequestedSession = HostedSessions.Find(RequestedSessionName);
+		const bool bIsRequestedSessionStarted = RequestedSession && (RequestedSession->State == EEOSSessionState::Starting || RequestedSession->State == EEOSSessionState::InProgress);
+		Rejection = bIsRequestedSessionStarted && !bAllowJoinInProgress ? TEXT("InProgress") : TEXT("Full");
+		ErrorMessage = bIsRequestedSessionStarted && !bAllowJoinInProgress ? TEXT("Match already started.") : TEXT("Server full.");
+	}
+
+	if (UEOS_TelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UEOS_TelemetrySubsystem>()) {
+		Telemetry->RecordAdmission(Rejection ? Rejection : TEXT("Admitted"));
+	}
+	if (Rejection) {
+		UE_LOG(LogTemp, Log, TEXT("Player %s turned away : %s"), *UniqueId.ToString(), *ErrorMessage);
+		return ErrorMessage;
+	}
+
+	// Hold its slot until it logs in, RegisterPlayer routes it there
+	if (bCanRegister) {
+		HostedSessions[HostedSessionName].Reservations.Add(UniqueId, FPlatformTime::Seconds() + AdmissionReservationTime);
+	}
+	return FString();
+}
+
 // Override base function to register player in EOS Session - Called Automatically when player join the server
 void AEOS_GameSession::RegisterPlayer(APlayerController* NewPlayer, const FUniqueNetIdRepl& UniqueId, bool bWasFromInvite) {
 	Super::RegisterPlayer(NewPlayer, UniqueId, bWasFromInvite);
 
 	// Only run on Dedicated Server
-	if (IsRunningDedicatedServer()) {
-		IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-		IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
-
-		RegisterPlayerDelegateHandle = Session->AddOnRegisterPlayersCompleteDelegate_Handle(FOnRegisterPlayersCompleteDelegate::CreateUObject(this, &AEOS_GameSession::HandleRegisterPlayerCompleted));
-	
-		if (!Session->RegisterPlayer(SessionName, *UniqueId, false)) {
-			UE_LOG(LogTemp, Warning, TEXT("Failed to register player !"));
-			Session->ClearOnRegisterPlayersCompleteDelegate_Handle(RegisterPlayerDelegateHandle);
-			RegisterPlayerDelegateHandle.Reset();
+	if (IsRunningDedicatedServer() && CanRegisterInSession(UniqueId)) {
+		FName RequestedSessionName;
+		if (const UNetConnection* Connection = NewPlayer->GetNetConnection()) {
+			FURL RequestURL(nullptr, *Connection->RequestURL, TRAVEL_Absolute);
+			RequestedSessionName = FName(RequestURL.GetOption(*(SETTING_HOSTEDSESSION.ToString() + TEXT("=")), TEXT("")));
+		}
+
+		const FName HostedSessionName = RouteNewPlayer(RequestedSessionName, UniqueId);
+		if (HostedSessionName.IsNone()) {
+			UE_LOG(LogTemp, Warning, TEXT("Failed to register player ! No hosted session can take a new player."));
+			return;
+		}
+
+		// The reserved slot becomes a routed player
+		FEOSHostedSession& HostedSession = HostedSessions[HostedSessionName];
+		HostedSession.Reservations.Remove(UniqueId);
+		HostedSession.NumberOfRoutedPlayers++;
+		PlayerSessions.Add(NewPlayer, HostedSessionName);
+
+		if (UEOS_TelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UEOS_TelemetrySubsystem>()) {
+			Telemetry->RecordPlayerJoining(NewPlayer, HostedSessionName);
+		}
+
+		// Queue the player, everyone joining during the batch window is registered with a single backend call
+		HostedSession.PendingRegistrations.Add(UniqueId.GetUniqueNetId().ToSharedRef());
+
+		if (RegistrationBatchWindow <= 0.f) {
+			FlushPendingRegistrations(HostedSessionName);
+		}
+		else if (!GetWorldTimerManager().IsTimerActive(HostedSession.RegistrationBatchTimerHandle)) {
+			GetWorldTimerManager().SetTimer(HostedSession.RegistrationBatchTimerHandle, FTimerDelegate::CreateUObject(this, &AEOS_GameSession::FlushPendingRegistrations, HostedSessionName), RegistrationBatchWindow, false);
+		}
+
+		// A standby session just got its first player, prepare the next one. Done last as it can add to HostedSessions.
+		if (HostedSession.NumberOfRoutedPlayers == 1) {
+			MaintainSessionPool();
 		}
 	}
 }
 
-void AEOS_GameSession::HandleRegisterPlayerCompleted(FName EOSSessionName, const TArray<FUniqueNetIdRef>& PlayerIds, bool bWasSuccessful ) {
-	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
+void AEOS_GameSession::FlushPendingRegistrations(FName HostedSessionName) {
+	FEOSHostedSession* HostedSession = HostedSessions.Find(HostedSessionName);
+	if (!HostedSession || HostedSession->PendingRegistrations.Num() == 0) {
+		return;
+	}
+
+	TArray<FUniqueNetIdRef> Batch = MoveTemp(HostedSession->PendingRegistrations);
+	HostedSession->PendingRegistrations.Reset();
+
+	UE_LOG(LogTemp, Log, TEXT("Registering %d player(s) in EOS Session %s..."), Batch.Num(), *HostedSessionName.ToString());
+	SessionOperations->RegisterPlayers(HostedSessionName, Batch, FOnEOSSessionOperationCompleted::CreateUObject(this, &AEOS_GameSession::HandleRegisterPlayerCompleted, HostedSessionName, Batch));
+}
+
+void AEOS_GameSession::HandleRegisterPlayerCompleted(EEOSSessionOperationResult Result, FName HostedSessionName, TArray<FUniqueNetIdRef> PlayerIds) {
+	FEOSHostedSession* HostedSession = HostedSessions.Find(HostedSessionName);
+	if (!HostedSession) {
+		return;
+	}
+
+	if (Result == EEOSSessionOperationResult::Success) {
+		UE_LOG(LogTemp, Log, TEXT("%d player(s) Registered in EOS Session %s !"), PlayerIds.Num(), *HostedSessionName.ToString());
+		const int32 PreviousNumberOfPlayersInSession = HostedSession->RegisteredPlayers.Num();
+
+		// Players who left while the batch was in flight are already queued for unregistration, they don't count
+		for (const FUniqueNetIdRef& PlayerId : PlayerIds) {
+			if (IsPlayerConnectedTo(HostedSessionName, *PlayerId) && !ContainsPlayer(HostedSession->RegisteredPlayers, *PlayerId)) {
+				HostedSession->RegisteredPlayers.Add(PlayerId);
+			}
+		}
 
-	if (bWasSuccessful) {
-		UE_LOG(LogTemp, Log, TEXT("Player Registered in EOS Session !"));
-		NumberOfPlayersInSession++;
-		if (NumberOfPlayersInSession == MaxNumberOfPlayersInSession) {
-			StartSession(); // Start the session when we reached the maximum number of players in the session
+		if (PreviousNumberOfPlayersInSession < MaxNumberOfPlayersInSession && HostedSession->RegisteredPlayers.Num() >= MaxNumberOfPlayersInSession) {
+			StartSession(HostedSessionName); // Start the session when we reached the maximum number of players in the session
 		}
 	}
 	else {
 		UE_LOG(LogTemp, Warning, TEXT("Failed to register player ! (From Callback)"));
 	}
-
-	// Clear and reset delegate
-	Session->ClearOnRegisterPlayersCompleteDelegate_Handle(RegisterPlayerDelegateHandle);
-	RegisterPlayerDelegateHandle.Reset();
 }
 
-void AEOS_GameSession::StartSession() {
-	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
+void AEOS_GameSession::StartSession(FName HostedSessionName) {
+	SetSessionState(HostedSessions[HostedSessionName], EEOSSessionState::Starting);
+	StartReplayRecording(HostedSessionName);
+	SessionOperations->StartSession(HostedSessionName, FOnEOSSessionOperationCompleted::CreateUObject(this, &AEOS_GameSession::HandleStartSessionCompleted, HostedSessionName));
+}
 
-	StartSessionDelegateHandle = Session->AddOnStartSessionCompleteDelegate_Handle(FOnStartSessionCompleteDelegate::CreateUObject(this, &AEOS_GameSession::HandleStartSessionCompleted));
+void AEOS_GameSession::HandleStartSessionCompleted(EEOSSessionOperationResult Result, FName HostedSessionName) {
+	FEOSHostedSession* HostedSession = HostedSessions.Find(HostedSessionName);
+	if (!HostedSession || HostedSession->State != EEOSSessionState::Starting) {
+		return;
+	}
 
-	if (!Session->StartSession(SessionName)) {
-		UE_LOG(LogTemp, Warning, TEXT("Failed to start session !"));
-		Session->ClearOnStartSessionCompleteDelegate_Handle(StartSessionDelegateHandle);
-		StartSessionDelegateHandle.Reset();
+	if (Result == EEOSSessionOperationResult::Success) {
+		SetSessionState(*HostedSession, EEOSSessionState::InProgress);
+		UE_LOG(LogTemp, Log, TEXT("Session %s started !"), *HostedSessionName.ToString());
+	}
+	else {
+		SetSessionState(*HostedSession, EEOSSessionState::Pending);
+		UE_LOG(LogTemp, Warning, TEXT("Failed to start session ! (From callback)"));
+		StopReplayRecordingIfIdle();
 	}
 }
 
-void AEOS_GameSession::HandleStartSessionCompleted(FName EOSSessionName, bool bWasSuccessful) {
-	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
+void AEOS_GameSession::StartReplayRecording(FName HostedSessionName) {
+	if (!bRecordReplays || !RecordingReplayName.IsEmpty() || !GetGameInstance()) {
+		return;
+	}
+
+	// One demo net driver per world, sessions starting while it records share its replay
+	RecordingReplayName = FString::Printf(TEXT("%s_%d_%s"), *HostedSessionName.ToString(), GetWorld()->URL.Port, *FDateTime::UtcNow().ToString());
+	GetGameInstance()->StartRecordingReplay(RecordingReplayName, HostedSessionName.ToString());
+	UE_LOG(LogTemp, Log, TEXT("Recording replay %s !"), *RecordingReplayName);
+}
 
-	if (bWasSuccessful) {
-		UE_LOG(LogTemp, Log, TEXT("Session started !"));
+void AEOS_GameSession::StopReplayRecordingIfIdle() {
+	if (RecordingReplayName.IsEmpty()) {
+		return;
 	}
-	else {
-		UE_LOG(LogTemp, Warning, TEXT("Failed to start session ! (From callback)"));
+	for (const TPair<FName, FEOSHostedSession>& HostedSession : HostedSessions) {
+		if (HostedSession.Value.State == EEOSSessionState::Starting || HostedSession.Value.State == EEOSSessionState::InProgress) {
+			return;
+		}
+	}
+
+	if (GetGameInstance()) {
+		GetGameInstance()->StopRecordingReplay();
 	}
 
-	Session->ClearOnStartSessionCompleteDelegate_Handle(StartSessionDelegateHandle);
-	StartSessionDelegateHandle.Reset();
+	// What recording cost the server, the same ratio the telemetry report exposes
+	const UEOS_TelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UEOS_TelemetrySubsystem>();
+	UE_LOG(LogTemp, Log, TEXT("Replay %s recorded, in %.2f%% of the world tick !"), *RecordingReplayName, Telemetry ? Telemetry->GetReplayRecordTickRatio() * 100.0 : -1.0);
+	RecordingReplayName.Empty();
 }
 
 void AEOS_GameSession::UnregisterPlayer(const APlayerController* ExitingPlayer) {
 	Super::UnregisterPlayer(ExitingPlayer);
 
 	if (IsRunningDedicatedServer()) {
-		IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-		IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
-		IOnlineIdentityPtr Identity = Subsystem->GetIdentityInterface();
+		const FName* HostedSessionName = PlayerSessions.Find(ExitingPlayer);
+		FEOSHostedSession* HostedSession = HostedSessionName ? HostedSessions.Find(*HostedSessionName) : nullptr;
 
 		// This is null if player left because crashes or network failure
-		if (ExitingPlayer->PlayerState) {
-			UnregisterPlayerDelegateHandle = Session->AddOnUnregisterPlayersCompleteDelegate_Handle(FOnUnregisterPlayersCompleteDelegate::CreateUObject(this, &AEOS_GameSession::HandleUnregisterPlayerCompleted));
+		if (HostedSession && ExitingPlayer->PlayerState && ExitingPlayer->PlayerState->GetUniqueId().IsValid()) {
+			FUniqueNetIdRef ExitingPlayerId = ExitingPlayer->PlayerState->GetUniqueId().GetUniqueNetId().ToSharedRef();
+
+			// Player left before its registration batch was sent, nothing to unregister on the backend
+			if (HostedSession->PendingRegistrations.RemoveAll([&ExitingPlayerId](const FUniqueNetIdRef& Player) { return *Player == *ExitingPlayerId; }) > 0) {
+				return;
+			}
+
+			HostedSession->PendingUnregistrations.Add(ExitingPlayerId);
 
-			if (!Session->UnregisterPlayer(SessionName, *ExitingPlayer->PlayerState->GetUniqueId())) {
-				UE_LOG(LogTemp, Warning, TEXT("Failed to Unregister Player !"));
-				Session->ClearOnUnregisterPlayersCompleteDelegate_Handle(UnregisterPlayerDelegateHandle);
-				UnregisterPlayerDelegateHandle.Reset();
+			if (RegistrationBatchWindow <= 0.f) {
+				FlushPendingUnregistrations(*HostedSessionName);
+			}
+			else if (!GetWorldTimerManager().IsTimerActive(HostedSession->UnregistrationBatchTimerHandle)) {
+				GetWorldTimerManager().SetTimer(HostedSession->UnregistrationBatchTimerHandle, FTimerDelegate::CreateUObject(this, &AEOS_GameSession::FlushPendingUnregistrations, *HostedSessionName), RegistrationBatchWindow, false);
 			}
 		}
 		else {
 			UE_LOG(LogTemp, Warning, TEXT("Failed to Unregister Player ! Player probably disconnected ungracefully."));
-			Session->ClearOnUnregisterPlayersCompleteDelegate_Handle(UnregisterPlayerDelegateHandle);
-			UnregisterPlayerDelegateHandle.Reset();
 		}
 	}
 }
 
-void AEOS_GameSession::HandleUnregisterPlayerCompleted(FName EOSSessionName, const TArray<FUniqueNetIdRef>& PlayerIds, bool bWasSuccessful) {
-	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
+void AEOS_GameSession::FlushPendingUnregistrations(FName HostedSessionName) {
+	FEOSHostedSession* HostedSession = HostedSessions.Find(HostedSessionName);
+	if (!HostedSession || HostedSession->PendingUnregistrations.Num() == 0) {
+		return;
+	}
+
+	TArray<FUniqueNetIdRef> Batch = MoveTemp(HostedSession->PendingUnregistrations);
+	HostedSession->PendingUnregistrations.Reset();
+
+	UE_LOG(LogTemp, Log, TEXT("Unregistering %d player(s) from EOS Session %s..."), Batch.Num(), *HostedSessionName.ToString());
+	SessionOperations->UnregisterPlayers(HostedSessionName, Batch, FOnEOSSessionOperationCompleted::CreateUObject(this, &AEOS_GameSession::HandleUnregisterPlayerCompleted, HostedSessionName, Batch));
+}
 
-	if (bWasSuccessful) {
-		UE_LOG(LogTemp, Log, TEXT("Player unregistered in EOS Session !"));
+void AEOS_GameSession::HandleUnregisterPlayerCompleted(EEOSSessionOperationResult Result, FName HostedSessionName, TArray<FUniqueNetIdRef> PlayerIds) {
+	if (Result == EEOSSessionOperationResult::Success) {
+		UE_LOG(LogTemp, Log, TEXT("%d player(s) unregistered in EOS Session %s !"), PlayerIds.Num(), *HostedSessionName.ToString());
 	}
 	else {
 		UE_LOG(LogTemp, Warning, TEXT("Failed to unregister player ! (From callback)"));
 	}
-
-	Session->ClearOnUnregisterPlayersCompleteDelegate_Handle(UnregisterPlayerDelegateHandle);
-	UnregisterPlayerDelegateHandle.Reset();
 }
 
 void AEOS_GameSession::NotifyLogout(const APlayerController* ExitingPlayer) {
+	const FName HostedSessionName = PlayerSessions.FindRef(ExitingPlayer);
+	FEOSHostedSession* HostedSession = HostedSessions.Find(HostedSessionName);
+	const FUniqueNetIdRepl ExitingPlayerId = ExitingPlayer->PlayerState ? ExitingPlayer->PlayerState->GetUniqueId() : FUniqueNetIdRepl();
+
 	Super::NotifyLogout(ExitingPlayer); // This also call UnregisterPlayer function
 
+	PlayerSessions.Remove(ExitingPlayer);
+
+	if (UEOS_TelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UEOS_TelemetrySubsystem>()) {
+		Telemetry->RecordPlayerLeft(ExitingPlayer);
+	}
+
 	// Dedicated Server Only - No matter if it fails to unregister player, end the session when all players left
-	if (IsRunningDedicatedServer()) {
-		NumberOfPlayersInSession--;
-		if (NumberOfPlayersInSession == 0) {
-			EndSession();
+	if (IsRunningDedicatedServer() && HostedSession) {
+		HostedSession->NumberOfRoutedPlayers--;
+
+		// A player leaving before the backend registered it has never been counted in the session
+		const int32 NumberOfRemovedPlayers = ExitingPlayerId.IsValid() ? HostedSession->RegisteredPlayers.RemoveAll([&ExitingPlayerId](const FUniqueNetIdRef& Player) { return *Player == *ExitingPlayerId; }) : 0;
+		const bool bWasStarted = HostedSession->State == EEOSSessionState::Starting || HostedSession->State == EEOSSessionState::InProgress;
+
+		// Players still routed here play on, whether their registration is in flight or failed
+		const bool bIsEmpty = HostedSession->RegisteredPlayers.Num() == 0 && HostedSession->NumberOfRoutedPlayers == 0;
+		if (bIsEmpty && (NumberOfRemovedPlayers > 0 || bWasStarted)) {
+			EndSession(HostedSessionName);
+		}
+
+		// The match goes on without it, keep its slot for a while in case it dropped
+		const bool bIsStarted = HostedSession->State == EEOSSessionState::Starting || HostedSession->State == EEOSSessionState::InProgress;
+		if (bIsStarted && ExitingPlayerId.IsValid() && DroppedPlayerReservationTime > 0.f) {
+			HostedSession->Reservations.Add(ExitingPlayerId, FPlatformTime::Seconds() + DroppedPlayerReservationTime);
 		}
 	}
-}
 
-void AEOS_GameSession::EndSession() {
-	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
+	// A match recycled while others were still played resets the world once the last player is gone
+	if (IsRunningDedicatedServer()) {
+		ResetLevelIfEmpty(ExitingPlayer);
+	}
+}
 
-	EndSessionDelegateHandle = Session->AddOnEndSessionCompleteDelegate_Handle(FOnEndSessionCompleteDelegate::CreateUObject(this, &AEOS_GameSession::HandleEndSessionCompleted));
+void AEOS_GameSession::EndSession(FName HostedSessionName) {
+	// Queued after any registration still in flight for this session
+	SetSessionState(HostedSessions[HostedSessionName], EEOSSessionState::Ending);
+	StopReplayRecordingIfIdle();
+	SessionOperations->EndSession(HostedSessionName, FOnEOSSessionOperationCompleted::CreateUObject(this, &AEOS_GameSession::HandleEndSessionCompleted, HostedSessionName));
+}
 
-	if (!Session->EndSession(SessionName)) {
-		UE_LOG(LogTemp, Warning, TEXT("Failed to end session !"));
-		Session->ClearOnEndSessionCompleteDelegate_Handle(EndSessionDelegateHandle);
-		EndSessionDelegateHandle.Reset();
+void AEOS_GameSession::HandleEndSessionCompleted(EEOSSessionOperationResult Result, FName HostedSessionName) {
+	FEOSHostedSession* HostedSession = HostedSessions.Find(HostedSessionName);
+	if (!HostedSession || HostedSession->State != EEOSSessionState::Ending) {
+		return;
 	}
-}
 
-void AEOS_GameSession::HandleEndSessionCompleted(FName EOSSessionName, bool bWasSuccessful) {
-	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
+	// Even if the backend refused, the match is over for the server
+	SetSessionState(*HostedSession, EEOSSessionState::Ended);
 
-	if (bWasSuccessful) {
-		UE_LOG(LogTemp, Log, TEXT("Session ended !"));
+	if (Result == EEOSSessionOperationResult::Success) {
+		UE_LOG(LogTemp, Log, TEXT("Session %s ended !"), *HostedSessionName.ToString());
 	}
 	else {
 		UE_LOG(LogTemp, Warning, TEXT("Failed to end session !"));
 	}
 
-	Session->ClearOnEndSessionCompleteDelegate_Handle(EndSessionDelegateHandle);
-	EndSessionDelegateHandle.Reset();
+	if (!bIsShuttingDown) {
+		RecycleSession(HostedSessionName);
+	}
 }
 
 void AEOS_GameSession::EndPlay(const EEndPlayReason::Type EndPlayReason) {
 	Super::EndPlay(EndPlayReason);
-	DestroySession();
-}
+	bIsShuttingDown = true;
+	GetWorldTimerManager().ClearTimer(SessionPoolBackoffTimerHandle);
+
+	// Flush the last chunk before the world and its demo net driver go away
+	if (!RecordingReplayName.IsEmpty() && GetGameInstance()) {
+		GetGameInstance()->StopRecordingReplay();
+		RecordingReplayName.Empty();
+	}
 
-void AEOS_GameSession::DestroySession() {
-	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
+	TArray<FName> HostedSessionNames;
+	HostedSessions.GetKeys(HostedSessionNames);
+	for (const FName& HostedSessionName : HostedSessionNames) {
+		// Nothing else matters for a session going away, only the destroy is kept
+		SessionOperations->CancelAll(HostedSessionName);
+
+		// Cancelling its create already dropped the session, the backend may have created it anyway
+		if (HostedSessions.Contains(HostedSessionName)) {
+			DestroySession(HostedSessionName);
+		}
+		else {
+			SessionOperations->DestroySession(HostedSessionName, FOnEOSSessionOperationCompleted());
+		}
+	}
 
-	DestroySessionDelegateHandle = Session->AddOnDestroySessionCompleteDelegate_Handle(FOnDestroySessionCompleteDelegate::CreateUObject(this, &AEOS_GameSession::HandleDestroySessionCompleted));
+	// The game session goes away with the world, nothing is left to answer the OSS callbacks. Players logging out after this queue nothing.
+	if (SessionOperations) {
+		SessionOperations->Shutdown();
+	}
+}
 
-	if (!Session->DestroySession(SessionName)) {
-		UE_LOG(LogTemp, Warning, TEXT("Failed to destroy session"));
-		Session->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionDelegateHandle);
-		DestroySessionDelegateHandle.Reset();
+void AEOS_GameSession::DestroySession(FName HostedSessionName) {
+	FEOSHostedSession* HostedSession = HostedSessions.Find(HostedSessionName);
+	if (!HostedSession) {
+		return;
 	}
+
+	SetSessionState(*HostedSession, EEOSSessionState::Destroying);
+	SessionOperations->DestroySession(HostedSessionName, FOnEOSSessionOperationCompleted::CreateUObject(this, &AEOS_GameSession::HandleDestroySessionCompleted, HostedSessionName));
 }
 
-void AEOS_GameSession::HandleDestroySessionCompleted(FName EOSSessionName, bool bWasSuccessful) {
-	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
+void AEOS_GameSession::HandleDestroySessionCompleted(EEOSSessionOperationResult Result, FName HostedSessionName) {
+	FEOSHostedSession* HostedSession = HostedSessions.Find(HostedSessionName);
+	if (!HostedSession || HostedSession->State != EEOSSessionState::Destroying) {
+		return;
+	}
+
+	// Every retry of the queue failed, drop the session anyway so the pool can replace it. Sessions never reuse a name.
+	HostedSessions.Remove(HostedSessionName);
+	if (UEOS_TelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UEOS_TelemetrySubsystem>()) {
+		Telemetry->RecordSessionRemoved(HostedSessionName);
+	}
 
-	if (bWasSuccessful) {
-		bSessionExists = false;
-		UE_LOG(LogTemp, Log, TEXT("Destroyed session successfully !"));
+	if (Result == EEOSSessionOperationResult::Success) {
+		UE_LOG(LogTemp, Log, TEXT("Destroyed session %s successfully !"), *HostedSessionName.ToString());
 	}
 	else {
-		UE_LOG(LogTemp, Log, TEXT("Failed to destroy session !"));
+		UE_LOG(LogTemp, Warning, TEXT("Failed to destroy session %s, dropping it !"), *HostedSessionName.ToString());
 	}
 
-	Session->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionDelegateHandle);
-	DestroySessionDelegateHandle.Reset();
+	// Replace the recycled session with a fresh advertised one
+	MaintainSessionPool();
 }
 
 // Create an EOS Session - Dedicated Server Only
-void AEOS_GameSession::CreateSession(FName KeyName, FString KeyValue)
+void AEOS_GameSession::CreateSession(FName HostedSessionName, FName KeyName, FString KeyValue)
 {
-	// Retrieve the session interface
-	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
-
-	// Bind delegate to callback function
-	CreateSessionDelegateHandle = Session->AddOnCreateSessionCompleteDelegate_Handle(FOnCreateSessionCompleteDelegate::CreateUObject(this, &AEOS_GameSession::HandleCreateSessionCompleted));
-
 	// Set session settings
 	TSharedRef<FOnlineSessionSettings> SessionSettings = MakeShared<FOnlineSessionSettings>();
 	SessionSettings->NumPublicConnections = MaxNumberOfPlayersInSession;
@@ -225,7 +629,7 @@ void AEOS_GameSession::CreateSession(FName KeyName, FString KeyValue)
 	SessionSettings->bAllowJoinViaPresence = false; // Superset by bShouldAdvertise and will be true on the backend.
 	SessionSettings->bAllowJoinViaPresenceFriendsOnly = false; // Superset by bShouldAdvertise and will be true on the backend.
 	SessionSettings->bAllowInvites = false; // Allow inviting players into session. This requires presence and a local user.
-	SessionSettings->bAllowJoinInProgress = false; // Once the session is started, no one can join.
+	SessionSettings->bAllowJoinInProgress = bAllowJoinInProgress; // Once the session is started, only dropped players can come back unless this is set.
 	SessionSettings->bIsDedicated = true; // Session created on dedicated server.
 	SessionSettings->bUseLobbiesIfAvailable = false; // This is an EOS Session not an EOS Lobby as they aren't supported on Dedicated Servers.
 	SessionSettings->bUseLobbiesVoiceChatIfAvailable = false; // We are not using lobbies
@@ -234,30 +638,56 @@ void AEOS_GameSession::CreateSession(FName KeyName, FString KeyValue)
 	// Add custom attribute used when searching on GameClients
 	SessionSettings->Settings.Add(KeyName, FOnlineSessionSetting((KeyValue), EOnlineDataAdvertisementType::ViaOnlineService));
 
-	// Create the Session
-	UE_LOG(LogTemp, Log, TEXT("Creating EOS Session..."));
+	// Tell clients which hosted session they are joining so the server can route them at login
+	SessionSettings->Settings.Add(SETTING_HOSTEDSESSION, FOnlineSessionSetting(HostedSessionName.ToString(), EOnlineDataAdvertisementType::ViaOnlineService));
 
-	if (!Session->CreateSession(0, SessionName, *SessionSettings)) {
-		UE_LOG(LogTemp, Warning, TEXT("Failed to create session !"));
-		Session->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionDelegateHandle);
-		CreateSessionDelegateHandle.Reset();
+	if (!ServerRegion.IsEmpty()) {
+		SessionSettings->Settings.Add(SETTING_SERVERREGION, FOnlineSessionSetting(ServerRegion, EOnlineDataAdvertisementType::ViaOnlineService));
 	}
+
+	// Several servers share the machine, each on its own port - Clients connect to exactly this one
+	if (!PublicAddress.IsEmpty()) {
+		const FString ServerAddress = FString::Printf(TEXT("%s:%d"), *PublicAddress, GetWorld()->URL.Port);
+		SessionSettings->Settings.Add(SETTING_SERVERADDRESS, FOnlineSessionSetting(ServerAddress, EOnlineDataAdvertisementType::ViaOnlineService));
+	}
+
+	FEOSHostedSession& HostedSession = HostedSessions.Add(HostedSessionName);
+	HostedSession.SessionName = HostedSessionName;
+	SetSessionState(HostedSession, EEOSSessionState::Creating);
+
+	// Create the Session
+	UE_LOG(LogTemp, Log, TEXT("Creating EOS Session %s..."), *HostedSessionName.ToString());
+	FEOSStartupTrace::Get().MarkPhase(EEOSStartupPhase::CreateSession);
+
+	SessionOperations->CreateSession(0, HostedSessionName, *SessionSettings, FOnEOSSessionOperationCompleted::CreateUObject(this, &AEOS_GameSession::HandleCreateSessionCompleted, HostedSessionName));
 }
 
 // Dedicated Server Only
-void AEOS_GameSession::HandleCreateSessionCompleted(FName EOSSessionName, bool bWasSuccessful)
+void AEOS_GameSession::HandleCreateSessionCompleted(EEOSSessionOperationResult Result, FName HostedSessionName)
 {
-	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
+	FEOSHostedSession* HostedSession = HostedSessions.Find(HostedSessionName);
+	if (!HostedSession || HostedSession->State != EEOSSessionState::Creating) {
+		return;
+	}
 
-	if (bWasSuccessful) {
-		bSessionExists = true;
-		UE_LOG(LogTemp, Log, TEXT("Session %s created !"), *EOSSessionName.ToString());
+	if (Result == EEOSSessionOperationResult::Success) {
+		NumberOfFailedCreates = 0;
+		SetSessionState(*HostedSession, EEOSSessionState::Pending);
+		UE_LOG(LogTemp, Log, TEXT("Session %s created !"), *HostedSessionName.ToString());
+		FEOSStartupTrace::Get().MarkPhase(EEOSStartupPhase::SessionAdvertised);
 	}
 	else {
+		HostedSessions.Remove(HostedSessionName);
+		if (UEOS_TelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UEOS_TelemetrySubsystem>()) {
+			Telemetry->RecordSessionRemoved(HostedSessionName);
+		}
 		UE_LOG(LogTemp, Warning, TEXT("Failed to create Session !"));
-	}
 
-	Session->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionDelegateHandle);
-	CreateSessionDelegateHandle.Reset();
+		// Replace it, with the same backoff as the queue's retries doubled for every create failing in a row
+		if (Result != EEOSSessionOperationResult::Cancelled && !bIsShuttingDown) {
+			const float BackoffDelay = FMath::Min(SessionOperationRetryDelay * FMath::Pow(2.f, FMath::Min(NumberOfFailedCreates, 10)), SessionOperationTimeout);
+			NumberOfFailedCreates++;
+			GetWorldTimerManager().SetTimer(SessionPoolBackoffTimerHandle, this, &AEOS_GameSession::MaintainSessionPool, FMath::Max(BackoffDelay, 0.01f), false);
+		}
+	}
 }
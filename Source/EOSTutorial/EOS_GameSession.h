@@ -4,46 +4,205 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/GameSession.h"
+#include "EOS_SessionOperations.h"
 #include "EOS_GameSession.generated.h"
 
+// Session attribute and travel URL option telling which hosted session a player belongs to
+#define SETTING_HOSTEDSESSION FName(TEXT("HostedSession"))
+
+// Session attribute holding the region of the server, used by clients to rank sessions
+#define SETTING_SERVERREGION FName(TEXT("ServerRegion"))
+
+// Session attribute holding the address clients connect to, advertised when the server is started with -PublicAddress=
+#define SETTING_SERVERADDRESS FName(TEXT("ServerAddress"))
+
+// Lifecycle of one EOS session hosted by the server
+enum class EEOSSessionState : uint8 {
+	Creating,
+	Pending, // Created and advertised, waiting for players
+	Starting,
+	InProgress,
+	Ending,
+	Ended,
+	Destroying
+};
+
+// Everything the server tracks for one of the EOS sessions it hosts
+struct FEOSHostedSession {
+	FName SessionName;
+	EEOSSessionState State = EEOSSessionState::Creating;
+
+	TArray<FUniqueNetIdRef> RegisteredPlayers; // Players the backend registered in the EOS session and still connected
+	int NumberOfRoutedPlayers = 0; // Players routed to this session at login, registered or not
+
+	TArray<FUniqueNetIdRef> PendingRegistrations; // Players waiting for the next registration batch
+
+	// Players the session keeps a slot for, with the time the slot is released: admitted and still loading the map, or dropped from the match
+	TMap<FUniqueNetIdRepl, double> Reservations;
+	TArray<FUniqueNetIdRef> PendingUnregistrations; // Players waiting for the next unregistration batch
+
+	FTimerHandle RegistrationBatchTimerHandle;
+	FTimerHandle UnregistrationBatchTimerHandle;
+};
+
 /**
- * 
+ * Host several EOS sessions (matches) from a single dedicated server process
  */
 UCLASS()
 class EOSTUTORIAL_API AEOS_GameSession : public AGameSession
 {
 	GENERATED_BODY()
-	
+
+	// Automation tests drive the session state machine without running a dedicated server
+	friend struct FEOSGameSessionTestAccess;
+
+public:
+	// Admission control, called by the game mode in PreLogin before the player gets a connection, a controller or a pawn.
+	// Returns why the player is turned away, empty when it is admitted and a slot is reserved for it
+	FString ApprovePlayer(const FString& Options, const FUniqueNetIdRepl& UniqueId);
+
+	// Load reported to the fleet allocator, see UEOS_FleetAgentSubsystem
+	int32 GetCapacity() const { return NumberOfSessions * MaxNumberOfPlayersInSession; }
+	int32 GetNumberOfOpenSlots() const; // Free slots of open sessions and of the sessions the pool can still create
+
+	// The fleet allocator only lets its least loaded servers open new matches - Matches already advertised go on
+	void SetAcceptingNewMatches(bool bAccept);
+	bool IsAcceptingNewMatches() const { return bIsAcceptingNewMatches; }
+
+	// Take down empty sessions and only let players with a reservation in, the fleet agent quits once the last player left
+	void StartDraining();
+	bool IsDraining() const { return bIsDraining; }
+
 private:
 	virtual void BeginPlay();
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason);
 	virtual bool ProcessAutoLogin();
 	virtual void NotifyLogout(const APlayerController* ExitingPlayer);
 	void RegisterPlayer(APlayerController* NewPlayer, const FUniqueNetIdRepl& UniqueId, bool bWasFromInvite);
-	void CreateSession(FName KeyName = "KeyName", FString KeyValue = "KeyValue");
-	void StartSession();
+	void CreateSession(FName HostedSessionName, FName KeyName = "KeyName", FString KeyValue = "KeyValue");
+	void StartSession(FName HostedSessionName);
 	void UnregisterPlayer(const APlayerController* ExitingPlayer);
-	void EndSession();
-	void DestroySession();
+	void EndSession(FName HostedSessionName);
+	void DestroySession(FName HostedSessionName);
+
+	// Create sessions until NumberOfStandbySessions empty sessions are advertised, without going over NumberOfSessions
+	void MaintainSessionPool();
+
+	// Destroy an ended session and let the pool replace it, the level is reset once the world is empty - The process keeps running
+	void RecycleSession(FName HostedSessionName);
+
+	// No player routed to any session, nor any other player controller than ExitingPlayer
+	bool IsWorldEmpty(const APlayerController* ExitingPlayer) const;
+
+	// Reset the level of the recycled matches, only once nobody plays in the world anymore
+	void ResetLevelIfEmpty(const APlayerController* ExitingPlayer);
+
+	// Record the whole world with the demo net driver while at least one hosted session is starting or in progress
+	void StartReplayRecording(FName HostedSessionName);
+	void StopReplayRecordingIfIdle();
+
+	// Change the state of a session and report it to telemetry
+	void SetSessionState(FEOSHostedSession& HostedSession, EEOSSessionState State);
+
+	// Pick the hosted session a joining player goes to: the one it has a reservation in, the one it asked for, or the fullest open one.
+	// NAME_None if every session is full or started
+	FName RouteNewPlayer(FName RequestedSessionName, const FUniqueNetIdRepl& UniqueId) const;
+
+	// Open to the player, with a slot left once the other players' reservations are kept
+	bool CanSessionTakePlayer(const FEOSHostedSession& HostedSession, const FUniqueNetIdRepl& UniqueId) const;
+
+	// The world tick leaves at least MinTickBudgetHeadroom of the server frame free
+	bool HasTickBudgetHeadroom() const;
+
+	void RemoveExpiredReservations();
+
+	// The id comes from the online subsystem hosting the sessions - Bots log in with Null ids, which an EOS server can't register
+	bool CanRegisterInSession(const FUniqueNetIdRepl& UniqueId) const;
+
+	// A controller routed to the session at login is still connected with this id
+	bool IsPlayerConnectedTo(FName HostedSessionName, const FUniqueNetId& PlayerId) const;
+
+	// Send every pending player of a session to the backend in a single RegisterPlayers / UnregisterPlayers call
+	void FlushPendingRegistrations(FName HostedSessionName);
+	void FlushPendingUnregistrations(FName HostedSessionName);
+
+	void HandleCreateSessionCompleted(EEOSSessionOperationResult Result, FName HostedSessionName);
+	void HandleRegisterPlayerCompleted(EEOSSessionOperationResult Result, FName HostedSessionName, TArray<FUniqueNetIdRef> PlayerIds);
+	void HandleStartSessionCompleted(EEOSSessionOperationResult Result, FName HostedSessionName);
+	void HandleUnregisterPlayerCompleted(EEOSSessionOperationResult Result, FName HostedSessionName, TArray<FUniqueNetIdRef> PlayerIds);
+	void HandleEndSessionCompleted(EEOSSessionOperationResult Result, FName HostedSessionName);
+	void HandleDestroySessionCompleted(EEOSSessionOperationResult Result, FName HostedSessionName);
+
+	// Queue of session operations for every hosted session. Only created on dedicated server.
+	TSharedPtr<FEOSSessionOperations> SessionOperations;
+
+	// Seconds to wait for a session operation callback before retrying it
+	UPROPERTY(Config)
+	float SessionOperationTimeout = 30.f;
+
+	// Retries of a failed or timed out session operation, with a delay doubled every time
+	UPROPERTY(Config)
+	int32 SessionOperationMaxRetries = 2;
+
+	UPROPERTY(Config)
+	float SessionOperationRetryDelay = 1.f;
+
+	// Maximum number of EOS sessions hosted by this server process
+	UPROPERTY(Config)
+	int32 NumberOfSessions = 4;
+
+	// Number of empty sessions kept created and advertised ahead of demand, so the next match doesn't wait for a CreateSession
+	UPROPERTY(Config)
+	int32 NumberOfStandbySessions = 2;
+
+	// Maximum Number of players in each session
+	UPROPERTY(Config)
+	int32 MaxNumberOfPlayersInSession = 2;
+
+	// Let players join sessions already started - Otherwise started sessions only take back players who dropped from them
+	UPROPERTY(Config)
+	bool bAllowJoinInProgress = false;
+
+	// Fraction of the server frame (1 / NetServerMaxTickRate) the world tick has to leave free for a new player to be admitted
+	UPROPERTY(Config)
+	float MinTickBudgetHeadroom = 0.2f;
+
+	// Seconds an admitted player keeps its slot while it loads the map and logs in
+	UPROPERTY(Config)
+	float AdmissionReservationTime = 60.f;
+
+	// Seconds the slot of a player leaving a started match is kept for it to come back, 0 to let anyone take it
+	UPROPERTY(Config)
+	float DroppedPlayerReservationTime = 60.f;
+
+	// Time (in seconds) during which joining / leaving players are gathered before being sent to the backend in one call
+	UPROPERTY(Config)
+	float RegistrationBatchWindow = 0.2f;
+
+	// Region advertised with every session, not advertised if empty
+	UPROPERTY(Config)
+	FString ServerRegion;
+
+	// Opt-in replay of the matches, streamed to Saved/Demos by the replay streamer of [NetworkReplayStreaming]
+	UPROPERTY(Config)
+	bool bRecordReplays = false;
+
+	FString RecordingReplayName; // Empty when not recording
+
+	FString SessionNamePrefix = "SessionName";
+	int32 NextSessionIndex = 0; // Recycled sessions get a new name so stale search results can't join them
 
-	void HandleCreateSessionCompleted(FName EOSSessionName, bool bWasSuccessful);
-	void HandleRegisterPlayerCompleted(FName EOSSessionName, const TArray<FUniqueNetIdRef>& PlayerIds, bool bWasSuccesful);
-	void HandleStartSessionCompleted(FName EOSSessionName, bool bWasSuccessful);
-	void HandleUnregisterPlayerCompleted(FName EOSSessionName, const TArray<FUniqueNetIdRef>& PlayerIds, bool bWasSuccessful);
-	void HandleEndSessionCompleted(FName EOSSessionName, bool bWasSuccessful);
-	void HandleDestroySessionCompleted(FName EOSSessionName, bool bWasSuccessful);
+	bool bIsShuttingDown = false; // Stop recycling sessions once the server is going down
+	bool bIsAcceptingNewMatches = true; // Create standby sessions ahead of demand
+	bool bIsDraining = false; // Stop creating sessions, the process is about to go
+	bool bIsLevelResetPending = false; // A session was recycled while the world was still in use
 
-	FDelegateHandle CreateSessionDelegateHandle; // Delegate to bind callback event for create session
-	FDelegateHandle RegisterPlayerDelegateHandle;
-	FDelegateHandle StartSessionDelegateHandle;
-	FDelegateHandle UnregisterPlayerDelegateHandle;
-	FDelegateHandle EndSessionDelegateHandle;
-	FDelegateHandle DestroySessionDelegateHandle;
+	int32 NumberOfFailedCreates = 0; // In a row, doubles the delay before the pool replaces the next failed session
+	FTimerHandle SessionPoolBackoffTimerHandle;
 
-	bool bSessionExists = false; // Track if the server already create a session or not
+	FString PublicAddress; // -PublicAddress=, host clients connect to, advertised with the port of the world
 
-	const int MaxNumberOfPlayersInSession = 2; // Maximum Number of players in the session
-	int NumberOfPlayersInSession = 0; // Tracking of number of player in Session
+	TMap<FName, FEOSHostedSession> HostedSessions; // Every session hosted by the server, by session name
 
-	FName SessionName = "SessionName";
+	TMap<const APlayerController*, FName> PlayerSessions; // Session each connected player has been routed to
 };
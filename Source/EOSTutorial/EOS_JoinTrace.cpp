@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_JoinTrace.h"
+#include "Trace/Trace.inl"
+
+UE_TRACE_CHANNEL(EOSJoinChannel)
+
+UE_TRACE_EVENT_BEGIN(EOSJoin, JoinStage)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, AttemptId)
+	UE_TRACE_EVENT_FIELD(uint8, Stage)
+UE_TRACE_EVENT_END()
+
+FEOSJoinTrace& FEOSJoinTrace::Get() {
+	static FEOSJoinTrace JoinTrace;
+	return JoinTrace;
+}
+
+FEOSJoinTrace::FEOSJoinTrace()
+	: Trace(TEXT("Join"), { TEXT("BeginPlay"), TEXT("Login"), TEXT("LoginCompleted"), TEXT("FindSessions"), TEXT("FindSessionsCompleted"),
+		TEXT("JoinSession"), TEXT("JoinSessionCompleted"), TEXT("Browse"), TEXT("InGame") }) {
+}
+
+void FEOSJoinTrace::BeginAttempt() {
+	Trace.Begin();
+}
+
+void FEOSJoinTrace::MarkStage(EEOSJoinStage Stage) {
+	if (Trace.Mark((int32)Stage)) {
+		UE_TRACE_LOG(EOSJoin, JoinStage, EOSJoinChannel)
+			<< JoinStage.Cycle(FPlatformTime::Cycles64())
+			<< JoinStage.AttemptId(Trace.GetRunId())
+			<< JoinStage.Stage((uint8)Stage);
+	}
+}
+
+void FEOSJoinTrace::EndAttempt(const FString& FailureReason) {
+	if (!Trace.IsRunning()) {
+		return;
+	}
+
+	const double StartTime = Trace.GetStartTime();
+	const double TotalMs = StartTime > 0.0 ? (FPlatformTime::Seconds() - StartTime) * 1000.0 : 0.0;
+	const FString Breakdown = Trace.End();
+	if (FailureReason.IsEmpty()) {
+		UE_LOG(LogTemp, Log, TEXT("Join attempt %u succeeded in %.1f ms -%s"), Trace.GetRunId(), TotalMs, *Breakdown);
+	}
+	else {
+		UE_LOG(LogTemp, Warning, TEXT("Join attempt %u failed after %.1f ms (%s) -%s"), Trace.GetRunId(), TotalMs, *FailureReason, *Breakdown);
+	}
+
+	// One line per attempt, stage columns are milliseconds since the first stage
+	Trace.AppendCsvLine(TEXT("Time,AttemptId,Result,TotalMs"), FString::Printf(TEXT("%s,%u,%s,%.1f"),
+		*FDateTime::UtcNow().ToIso8601(), Trace.GetRunId(), FailureReason.IsEmpty() ? TEXT("Success") : *FailureReason.Replace(TEXT(","), TEXT(" ")), TotalMs));
+}
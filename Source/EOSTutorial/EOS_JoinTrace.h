@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EOS_PhaseTrace.h"
+
+// Steps of the client join pipeline, in the order they run
+enum class EEOSJoinStage : uint8 {
+	BeginPlay,
+	Login,
+	LoginCompleted,
+	FindSessions,
+	FindSessionsCompleted,
+	JoinSession,
+	JoinSessionCompleted,
+	Browse,
+	InGame, // Pawn possessed on the server map
+	Count
+};
+
+/**
+ * Timestamps every stage of a join attempt, from BeginPlay to the first pawn on the server, through FEOSPhaseTrace.
+ * Stages are also sent to the EOSJoin trace channel (-trace=default,EOSJoin).
+ * Finished attempts are logged with a per stage breakdown and appended to Saved/Logs/JoinTrace.csv.
+ * Kept for the whole process as an attempt spans the travel to the server.
+ */
+class EOSTUTORIAL_API FEOSJoinTrace
+{
+public:
+	static FEOSJoinTrace& Get();
+
+	// Start a new attempt, unless one is already running
+	void BeginAttempt();
+
+	// Record a stage of the running attempt, the first time only
+	void MarkStage(EEOSJoinStage Stage);
+
+	// Log and save the breakdown of the running attempt. FailureReason is empty on success.
+	void EndAttempt(const FString& FailureReason = FString());
+
+	bool IsAttemptRunning() const { return Trace.IsRunning(); }
+
+private:
+	FEOSJoinTrace();
+
+	FEOSPhaseTrace Trace; // One run per attempt, one phase per EEOSJoinStage
+};
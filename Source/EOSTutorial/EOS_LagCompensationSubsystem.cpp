@@ -0,0 +1,292 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_LagCompensationSubsystem.h"
+#include "EOSTutorialCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+void FEOSPoseHistory::Init(int32 InMaxSlots, int32 InHistoryLength) {
+	MaxSlots = FMath::Max(InMaxSlots, 0);
+	HistoryLength = FMath::Max(InHistoryLength, 0);
+	NewestFrame = INDEX_NONE;
+	NumberOfFrames = 0;
+
+	FrameTimes.SetNumZeroed(HistoryLength);
+	Locations.SetNumZeroed(HistoryLength * MaxSlots);
+	HalfHeights.SetNumZeroed(HistoryLength * MaxSlots);
+
+	Radii.SetNumZeroed(MaxSlots);
+	SlotStartTimes.Init(-1.0, MaxSlots);
+	FreeSlots.Reset(MaxSlots);
+	for (int32 Slot = MaxSlots - 1; Slot >= 0; Slot--) {
+		FreeSlots.Add(Slot);
+	}
+}
+
+int32 FEOSPoseHistory::AllocateSlot(float Radius) {
+	if (FreeSlots.IsEmpty()) {
+		return INDEX_NONE;
+	}
+	const int32 Slot = FreeSlots.Pop(false);
+	Radii[Slot] = Radius;
+	SlotStartTimes[Slot] = TNumericLimits<double>::Max();
+	return Slot;
+}
+
+void FEOSPoseHistory::FreeSlot(int32 Slot) {
+	if (SlotStartTimes.IsValidIndex(Slot) && SlotStartTimes[Slot] >= 0.0) {
+		SlotStartTimes[Slot] = -1.0;
+		FreeSlots.Add(Slot);
+	}
+}
+
+void FEOSPoseHistory::BeginFrame(double Time) {
+	if (HistoryLength <= 0) {
+		return;
+	}
+	NewestFrame = (NewestFrame + 1) % HistoryLength;
+	NumberOfFrames = FMath::Min(NumberOfFrames + 1, HistoryLength);
+	FrameTimes[NewestFrame] = Time;
+}
+
+void FEOSPoseHistory::RecordPose(int32 Slot, const FVector& Location, float HalfHeight) {
+	if (NewestFrame == INDEX_NONE || !SlotStartTimes.IsValidIndex(Slot)) {
+		return;
+	}
+	const int32 Index = NewestFrame * MaxSlots + Slot;
+	Locations[Index] = FVector3f(Location);
+	HalfHeights[Index] = HalfHeight;
+	SlotStartTimes[Slot] = FMath::Min(SlotStartTimes[Slot], FrameTimes[NewestFrame]);
+}
+
+double FEOSPoseHistory::GetOldestTime() const {
+	return NumberOfFrames > 0 ? FrameTimes[GetFrame(NumberOfFrames - 1)] : 0.0;
+}
+
+double FEOSPoseHistory::GetNewestTime() const {
+	return NumberOfFrames > 0 ? FrameTimes[NewestFrame] : 0.0;
+}
+
+bool FEOSPoseHistory::FindFrames(double Time, int32& OutOlderFrame, int32& OutNewerFrame, float& OutAlpha) const {
+	if (NumberOfFrames == 0) {
+		return false;
+	}
+
+	// Binary search on the age of the first frame at or before Time, frames get older with the age
+	int32 Low = 0;
+	int32 High = NumberOfFrames - 1;
+	if (Time >= FrameTimes[GetFrame(0)]) {
+		High = 0;
+	}
+	else if (Time > FrameTimes[GetFrame(High)]) {
+		while (High - Low > 1) {
+			const int32 Middle = (Low + High) / 2;
+			if (FrameTimes[GetFrame(Middle)] > Time) {
+				Low = Middle;
+			}
+			else {
+				High = Middle;
+			}
+		}
+	}
+
+	OutOlderFrame = GetFrame(High);
+	OutNewerFrame = GetFrame(FMath::Max(High - 1, 0));
+	const double OlderTime = FrameTimes[OutOlderFrame];
+	const double NewerTime = FrameTimes[OutNewerFrame];
+	OutAlpha = NewerTime > OlderTime ? (float)FMath::Clamp((Time - OlderTime) / (NewerTime - OlderTime), 0.0, 1.0) : 0.f;
+	return true;
+}
+
+bool FEOSPoseHistory::GetCapsule(int32 Slot, double Time, FVector& OutLocation, float& OutHalfHeight, float& OutRadius) const {
+	int32 OlderFrame;
+	int32 NewerFrame;
+	float Alpha;
+	if (!SlotStartTimes.IsValidIndex(Slot) || SlotStartTimes[Slot] < 0.0 || SlotStartTimes[Slot] > GetNewestTime() || !FindFrames(FMath::Max(Time, SlotStartTimes[Slot]), OlderFrame, NewerFrame, Alpha)) {
+		return false;
+	}
+
+	const int32 OlderIndex = OlderFrame * MaxSlots + Slot;
+	const int32 NewerIndex = NewerFrame * MaxSlots + Slot;
+	OutLocation = FVector(FMath::Lerp(Locations[OlderIndex], Locations[NewerIndex], Alpha));
+	OutHalfHeight = FMath::Lerp(HalfHeights[OlderIndex], HalfHeights[NewerIndex], Alpha);
+	OutRadius = Radii[Slot];
+	return true;
+}
+
+int32 FEOSPoseHistory::LineTrace(double Time, const FVector& Start, const FVector& End, int32 IgnoredSlot, FVector& OutHitLocation) const {
+	int32 OlderFrame;
+	int32 NewerFrame;
+	float Alpha;
+	// Without slots the frames have no poses to point into
+	if (MaxSlots <= 0 || !FindFrames(Time, OlderFrame, NewerFrame, Alpha)) {
+		return INDEX_NONE;
+	}
+
+	const FVector3f SegmentStart(Start);
+	const FVector3f SegmentEnd(End);
+	const FVector3f* OlderLocations = &Locations[OlderFrame * MaxSlots];
+	const FVector3f* NewerLocations = &Locations[NewerFrame * MaxSlots];
+	const float* OlderHalfHeights = &HalfHeights[OlderFrame * MaxSlots];
+	const float* NewerHalfHeights = &HalfHeights[NewerFrame * MaxSlots];
+
+	int32 HitSlot = INDEX_NONE;
+	float HitDistanceSquared = TNumericLimits<float>::Max();
+	for (int32 Slot = 0; Slot < MaxSlots; Slot++) {
+		// Free slots and characters that did not exist yet at that time
+		if (Slot == IgnoredSlot || SlotStartTimes[Slot] < 0.0 || SlotStartTimes[Slot] > Time) {
+			continue;
+		}
+
+		const FVector3f Location = FMath::Lerp(OlderLocations[Slot], NewerLocations[Slot], Alpha);
+		const float CylinderHalfHeight = FMath::Max(FMath::Lerp(OlderHalfHeights[Slot], NewerHalfHeights[Slot], Alpha) - Radii[Slot], 0.f);
+		const FVector3f AxisOffset(0.f, 0.f, CylinderHalfHeight);
+
+		// The segment crosses the capsule when it comes closer than the radius to its axis
+		FVector3f SegmentPoint;
+		FVector3f AxisPoint;
+		FMath::SegmentDistToSegmentSafe(SegmentStart, SegmentEnd, Location - AxisOffset, Location + AxisOffset, SegmentPoint, AxisPoint);
+		if (FVector3f::DistSquared(SegmentPoint, AxisPoint) > FMath::Square(Radii[Slot])) {
+			continue;
+		}
+
+		const float DistanceSquared = FVector3f::DistSquared(SegmentStart, SegmentPoint);
+		if (DistanceSquared < HitDistanceSquared) {
+			HitDistanceSquared = DistanceSquared;
+			HitSlot = Slot;
+			OutHitLocation = FVector(SegmentPoint);
+		}
+	}
+	return HitSlot;
+}
+
+bool UEOS_LagCompensationSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+	// Hits are validated where the authority is, clients never rewind
+	return Super::ShouldCreateSubsystem(Outer) && IsRunningDedicatedServer();
+}
+
+void UEOS_LagCompensationSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	History.Init(MaxCharacters, HistoryLength);
+	SlotCharacters.SetNum(MaxCharacters);
+	CharacterSlots.Reserve(MaxCharacters);
+}
+
+void UEOS_LagCompensationSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	// Tickables run after every tick group, characters are done moving for this frame
+	History.BeginFrame(GetWorld()->GetTimeSeconds());
+	for (int32 Slot = 0; Slot < SlotCharacters.Num(); Slot++) {
+		if (const AEOSTutorialCharacter* Character = SlotCharacters[Slot].Get()) {
+			const UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+			History.RecordPose(Slot, Capsule->GetComponentLocation(), Capsule->GetScaledCapsuleHalfHeight());
+		}
+	}
+}
+
+TStatId UEOS_LagCompensationSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEOS_LagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+void UEOS_LagCompensationSubsystem::RegisterCharacter(AEOSTutorialCharacter* Character) {
+	if (CharacterSlots.Contains(Character)) {
+		return;
+	}
+
+	const int32 Slot = History.AllocateSlot(Character->GetCapsuleComponent()->GetScaledCapsuleRadius());
+	if (Slot == INDEX_NONE) {
+		UE_LOG(LogTemp, Warning, TEXT("Lag compensation is full, %s will not be rewound !"), *Character->GetName());
+		return;
+	}
+	SlotCharacters[Slot] = Character;
+	CharacterSlots.Add(Character, Slot);
+}
+
+void UEOS_LagCompensationSubsystem::UnregisterCharacter(AEOSTutorialCharacter* Character) {
+	int32 Slot;
+	if (CharacterSlots.RemoveAndCopyValue(Character, Slot)) {
+		SlotCharacters[Slot] = nullptr;
+		History.FreeSlot(Slot);
+	}
+}
+
+double UEOS_LagCompensationSubsystem::ClampRewindTime(double Time) const {
+	const double Now = GetWorld()->GetTimeSeconds();
+	return FMath::Clamp(Time, Now - MaxRewindTime, Now);
+}
+
+bool UEOS_LagCompensationSubsystem::GetCharacterCapsuleAtTime(const AEOSTutorialCharacter* Character, double Time, FVector& OutLocation, float& OutHalfHeight, float& OutRadius) const {
+	const int32* Slot = CharacterSlots.Find(Character);
+	return Slot && History.GetCapsule(*Slot, ClampRewindTime(Time), OutLocation, OutHalfHeight, OutRadius);
+}
+
+AEOSTutorialCharacter* UEOS_LagCompensationSubsystem::RewindLineTrace(double Time, const FVector& Start, const FVector& End, const AEOSTutorialCharacter* Shooter, FVector& OutHitLocation) const {
+	const int32* ShooterSlot = CharacterSlots.Find(Shooter);
+	const int32 HitSlot = History.LineTrace(ClampRewindTime(Time), Start, End, ShooterSlot ? *ShooterSlot : INDEX_NONE, OutHitLocation);
+	AEOSTutorialCharacter* HitCharacter = HitSlot != INDEX_NONE ? SlotCharacters[HitSlot].Get() : nullptr;
+
+	// The server only ticks montages, the hit is confirmed against the bones next and they need the full pose
+	if (HitCharacter) {
+		HitCharacter->RequestBoneAccuratePose();
+	}
+	return HitCharacter;
+}
+
+// Cost of history lookups on synthetic characters walking around, runs anywhere, no world needed
+static FAutoConsoleCommand LagCompensationBenchmarkCommand(
+	TEXT("EOS.LagCompensationBenchmark"),
+	TEXT("EOS.LagCompensationBenchmark [Characters=128] [Queries=100000] - Time capsule and line trace rewinds over a full history"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args) {
+		const int32 NumberOfCharacters = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 128;
+		const int32 NumberOfQueries = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 100000;
+		const int32 HistoryLength = GetDefault<UEOS_LagCompensationSubsystem>()->GetHistoryLength();
+		const double FrameTime = 1.0 / 30.0;
+
+		FRandomStream Random(34);
+		FEOSPoseHistory History;
+		History.Init(NumberOfCharacters, HistoryLength);
+		TArray<FVector> Positions;
+		TArray<FVector> Velocities;
+		for (int32 Character = 0; Character < NumberOfCharacters; Character++) {
+			History.AllocateSlot(42.f);
+			Positions.Add(FVector(Random.FRandRange(-5000.f, 5000.f), Random.FRandRange(-5000.f, 5000.f), 96.f));
+			Velocities.Add(FVector(Random.FRandRange(-500.f, 500.f), Random.FRandRange(-500.f, 500.f), 0.f));
+		}
+		for (int32 Frame = 0; Frame < HistoryLength; Frame++) {
+			History.BeginFrame(Frame * FrameTime);
+			for (int32 Character = 0; Character < NumberOfCharacters; Character++) {
+				Positions[Character] += Velocities[Character] * FrameTime;
+				History.RecordPose(Character, Positions[Character], 96.f);
+			}
+		}
+
+		const double OldestTime = History.GetOldestTime();
+		const double NewestTime = History.GetNewestTime();
+		FVector Location;
+		float HalfHeight;
+		float Radius;
+		int32 NumberOfFound = 0;
+		uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Query = 0; Query < NumberOfQueries; Query++) {
+			NumberOfFound += History.GetCapsule(Query % NumberOfCharacters, Random.FRandRange(OldestTime, NewestTime), Location, HalfHeight, Radius) ? 1 : 0;
+		}
+		const double CapsuleNs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000000.0 / FMath::Max(NumberOfQueries, 1);
+
+		// Traces go through the whole area, every capsule of the frame is tested
+		const int32 NumberOfTraces = FMath::Max(NumberOfQueries / 100, 1);
+		int32 NumberOfHits = 0;
+		StartCycles = FPlatformTime::Cycles64();
+		for (int32 Query = 0; Query < NumberOfTraces; Query++) {
+			const FVector Start(Random.FRandRange(-5000.f, 5000.f), -6000.f, 96.f);
+			const FVector End(Random.FRandRange(-5000.f, 5000.f), 6000.f, 96.f);
+			NumberOfHits += History.LineTrace(Random.FRandRange(OldestTime, NewestTime), Start, End, INDEX_NONE, Location) != INDEX_NONE ? 1 : 0;
+		}
+		const double TraceNs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000000.0 / NumberOfTraces;
+
+		UE_LOG(LogTemp, Log, TEXT("Lag compensation benchmark - %d characters, %d frames: capsule rewind %.1f ns (%d found), line trace rewind %.1f ns (%d hits of %d)"),
+			NumberOfCharacters, HistoryLength, CapsuleNs, NumberOfFound, TraceNs, NumberOfHits, NumberOfTraces);
+	}));
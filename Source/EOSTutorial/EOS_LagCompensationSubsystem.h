@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EOS_LagCompensationSubsystem.generated.h"
+
+class AEOSTutorialCharacter;
+
+/**
+ * Capsules of every tracked character over the last HistoryLength frames, in a ring of frames.
+ * Structure of arrays, frame major: a frame is a contiguous run of locations and half heights,
+ * so a rewind only touches the two frames around the time it asks for. Nothing allocates after Init.
+ */
+class EOSTUTORIAL_API FEOSPoseHistory
+{
+public:
+	void Init(int32 InMaxSlots, int32 InHistoryLength);
+
+	// Slot of a new capsule, part of the history from its first recorded pose on. INDEX_NONE when every slot is taken
+	int32 AllocateSlot(float Radius);
+	void FreeSlot(int32 Slot);
+
+	// Start a new frame over the oldest one, then record every allocated slot in it
+	void BeginFrame(double Time);
+	void RecordPose(int32 Slot, const FVector& Location, float HalfHeight);
+
+	// Capsule of a slot at Time, interpolated between the two frames around it, clamped to the history
+	bool GetCapsule(int32 Slot, double Time, FVector& OutLocation, float& OutHalfHeight, float& OutRadius) const;
+
+	// Closest capsule crossed by the segment at Time, INDEX_NONE if none. OutHitLocation is the closest point on the segment
+	int32 LineTrace(double Time, const FVector& Start, const FVector& End, int32 IgnoredSlot, FVector& OutHitLocation) const;
+
+	double GetOldestTime() const;
+	double GetNewestTime() const;
+
+private:
+	// Automation tests check the frames a time falls between, and that nothing allocates after Init
+	friend struct FEOSPoseHistoryTestAccess;
+
+	// Older and newer physical frame around Time, and the blend from one to the other
+	bool FindFrames(double Time, int32& OutOlderFrame, int32& OutNewerFrame, float& OutAlpha) const;
+	int32 GetFrame(int32 Age) const { return (NewestFrame - Age + HistoryLength) % HistoryLength; }
+
+	int32 MaxSlots = 0;
+	int32 HistoryLength = 0;
+	int32 NewestFrame = INDEX_NONE;
+	int32 NumberOfFrames = 0;
+
+	TArray<double> FrameTimes; // HistoryLength
+	TArray<FVector3f> Locations; // HistoryLength * MaxSlots
+	TArray<float> HalfHeights; // HistoryLength * MaxSlots
+
+	TArray<float> Radii; // MaxSlots
+	TArray<double> SlotStartTimes; // MaxSlots, time of the first recorded frame, negative for free slots, max until recorded
+	TArray<int32> FreeSlots;
+};
+
+/**
+ * Server side lag compensation - Records the capsule of every AEOSTutorialCharacter each frame, after movement,
+ * so hit validation can rewind to the time a client saw the world instead of trusting it or using the present.
+ */
+UCLASS(config=Game)
+class EOSTUTORIAL_API UEOS_LagCompensationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Called by characters on the server when they begin and end play
+	void RegisterCharacter(AEOSTutorialCharacter* Character);
+	void UnregisterCharacter(AEOSTutorialCharacter* Character);
+
+	// Capsule of a character at a server time, at most MaxRewindTime in the past
+	bool GetCharacterCapsuleAtTime(const AEOSTutorialCharacter* Character, double Time, FVector& OutLocation, float& OutHalfHeight, float& OutRadius) const;
+
+	// Rewind every character to a server time and trace a segment against their capsules, the shooter is ignored.
+	// The character hit evaluates its full pose, for a bone accurate check of the hit
+	AEOSTutorialCharacter* RewindLineTrace(double Time, const FVector& Start, const FVector& End, const AEOSTutorialCharacter* Shooter, FVector& OutHitLocation) const;
+
+	int32 GetHistoryLength() const { return HistoryLength; }
+
+private:
+	double ClampRewindTime(double Time) const;
+
+	// Frames kept, 64 is two seconds at the default 30 Hz server tick rate
+	UPROPERTY(Config)
+	int32 HistoryLength = 64;
+
+	UPROPERTY(Config)
+	int32 MaxCharacters = 256;
+
+	// Oldest a client can ask for, older requests are clamped
+	UPROPERTY(Config)
+	float MaxRewindTime = 0.5f;
+
+	FEOSPoseHistory History;
+
+	// Character of every slot, null for free slots
+	TArray<TWeakObjectPtr<AEOSTutorialCharacter>> SlotCharacters;
+	TMap<const AEOSTutorialCharacter*, int32> CharacterSlots;
+};
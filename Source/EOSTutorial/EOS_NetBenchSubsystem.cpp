@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_NetBenchSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+FEOSNetBenchCounters FEOSNetBenchCounters::Sample(const UNetDriver& NetDriver) {
+	FEOSNetBenchCounters Counters;
+	Counters.InBytes = NetDriver.InTotalBytes;
+	Counters.OutBytes = NetDriver.OutTotalBytes;
+	Counters.InPackets = NetDriver.InTotalPackets;
+	Counters.OutPackets = NetDriver.OutTotalPackets;
+	Counters.InPacketsLost = NetDriver.InTotalPacketsLost;
+	Counters.OutPacketsLost = NetDriver.OutTotalPacketsLost;
+	return Counters;
+}
+
+bool UEOS_NetBenchSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+	return Super::ShouldCreateSubsystem(Outer) && FParse::Param(FCommandLine::Get(), TEXT("NetBench"));
+}
+
+void UEOS_NetBenchSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	const TCHAR* CommandLine = FCommandLine::Get();
+	if (!FParse::Value(CommandLine, TEXT("NetBenchTransport="), Transport)) {
+		Transport = TEXT("Default");
+	}
+	FParse::Value(CommandLine, TEXT("NetBenchDuration="), Duration);
+	if (!FParse::Value(CommandLine, TEXT("NetBenchReport="), ReportPath)) {
+		ReportPath = FPaths::ProjectSavedDir() / TEXT("NetBench") / FString::Printf(TEXT("%s_%u.csv"), IsRunningDedicatedServer() ? TEXT("Server") : TEXT("Client"), FPlatformProcess::GetCurrentProcessId());
+	}
+
+	WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UEOS_NetBenchSubsystem::HandleWorldTickStart);
+	PostTickDispatchHandle = GetWorld()->OnPostTickDispatch().AddUObject(this, &UEOS_NetBenchSubsystem::HandlePostTickDispatch);
+	WorldPostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UEOS_NetBenchSubsystem::HandleWorldPostActorTick);
+	PostTickFlushHandle = GetWorld()->OnPostTickFlush().AddUObject(this, &UEOS_NetBenchSubsystem::HandlePostTickFlush);
+}
+
+void UEOS_NetBenchSubsystem::Deinitialize() {
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+	GetWorld()->OnPostTickDispatch().Remove(PostTickDispatchHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(WorldPostActorTickHandle);
+	GetWorld()->OnPostTickFlush().Remove(PostTickFlushHandle);
+
+	// A window cut short still says something, the report tells how long it lasted
+	WriteReport();
+
+	Super::Deinitialize();
+}
+
+void UEOS_NetBenchSubsystem::ApplyTransport() {
+	FString Transport;
+	if (!FParse::Param(FCommandLine::Get(), TEXT("NetBench")) || !FParse::Value(FCommandLine::Get(), TEXT("NetBenchTransport="), Transport) || Transport != TEXT("Ip")) {
+		return;
+	}
+
+	// The fallback of the game net driver is the plain IpNetDriver, see DefaultEngine.ini
+	for (FNetDriverDefinition& NetDriverDefinition : GEngine->NetDriverDefinitions) {
+		if (NetDriverDefinition.DefName == NAME_GameNetDriver) {
+			NetDriverDefinition.DriverClassName = NetDriverDefinition.DriverClassNameFallback;
+			UE_LOG(LogTemp, Log, TEXT("Net benchmark running the game net driver as %s"), *NetDriverDefinition.DriverClassName.ToString());
+		}
+	}
+}
+
+void UEOS_NetBenchSubsystem::RecordReplicationLatency(float Milliseconds) {
+	if (IsWindowRunning()) {
+		ReplicationLatenciesMs.Add(Milliseconds);
+	}
+}
+
+void UEOS_NetBenchSubsystem::RecordCorrection() {
+	if (IsWindowRunning()) {
+		NumberOfCorrections++;
+	}
+}
+
+void UEOS_NetBenchSubsystem::HandleWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaTime) {
+	// Net drivers tick dispatch right after
+	if (World == GetWorld()) {
+		ReceiveStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void UEOS_NetBenchSubsystem::HandlePostTickDispatch() {
+	if (ReceiveStartTime > 0.0 && IsWindowRunning()) {
+		ReceiveSeconds += FPlatformTime::Seconds() - ReceiveStartTime;
+	}
+	ReceiveStartTime = 0.0;
+}
+
+void UEOS_NetBenchSubsystem::HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime) {
+	// Net drivers tick flush right after
+	if (World == GetWorld()) {
+		SendStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void UEOS_NetBenchSubsystem::HandlePostTickFlush() {
+	const double Now = FPlatformTime::Seconds();
+	if (SendStartTime > 0.0 && IsWindowRunning()) {
+		SendSeconds += Now - SendStartTime;
+	}
+	SendStartTime = 0.0;
+
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (!NetDriver || bHasWrittenReport) {
+		return;
+	}
+
+	// The window opens with the first connection, the handshake is part of it
+	if (WindowStartTime <= 0.0) {
+		if (NetDriver->ServerConnection || NetDriver->ClientConnections.Num() > 0) {
+			WindowStartTime = LastSampleTime = Now;
+			FirstCounters = LastCounters = FEOSNetBenchCounters::Sample(*NetDriver);
+		}
+		return;
+	}
+
+	// Kept every frame, the net driver may be gone by the time the report is written
+	LastSampleTime = Now;
+	LastCounters = FEOSNetBenchCounters::Sample(*NetDriver);
+
+	if (Duration > 0.f && Now - WindowStartTime >= Duration) {
+		WriteReport();
+		if (IsRunningDedicatedServer()) {
+			FPlatformMisc::RequestExit(false);
+		}
+	}
+}
+
+void UEOS_NetBenchSubsystem::WriteReport() {
+	if (bHasWrittenReport || WindowStartTime <= 0.0) {
+		return;
+	}
+	bHasWrittenReport = true;
+
+	const double Seconds = FMath::Max(LastSampleTime - WindowStartTime, UE_SMALL_NUMBER);
+	const uint64 InPackets = LastCounters.InPackets - FirstCounters.InPackets;
+	const uint64 OutPackets = LastCounters.OutPackets - FirstCounters.OutPackets;
+	const double InKBps = (LastCounters.InBytes - FirstCounters.InBytes) / Seconds / 1024.0;
+	const double OutKBps = (LastCounters.OutBytes - FirstCounters.OutBytes) / Seconds / 1024.0;
+	const double ReceiveUsPerPacket = InPackets > 0 ? ReceiveSeconds * 1000000.0 / InPackets : -1.0;
+	const double SendUsPerPacket = OutPackets > 0 ? SendSeconds * 1000000.0 / OutPackets : -1.0;
+	const double CpuUsPerPacket = InPackets + OutPackets > 0 ? (ReceiveSeconds + SendSeconds) * 1000000.0 / (InPackets + OutPackets) : -1.0;
+
+	float LatencyAverage = -1.f;
+	float LatencyP95 = -1.f;
+	if (ReplicationLatenciesMs.Num() > 0) {
+		ReplicationLatenciesMs.Sort();
+		float Sum = 0.f;
+		for (float Latency : ReplicationLatenciesMs) {
+			Sum += Latency;
+		}
+		LatencyAverage = Sum / ReplicationLatenciesMs.Num();
+		LatencyP95 = ReplicationLatenciesMs[FMath::Min(FMath::FloorToInt(ReplicationLatenciesMs.Num() * 0.95f), ReplicationLatenciesMs.Num() - 1)];
+	}
+
+	// The emulation this process ran with, as NetBench.sh passed it
+	float PacketLoss = 0.f;
+	float Lag = 0.f;
+	float LagVariance = 0.f;
+	FParse::Value(FCommandLine::Get(), TEXT("PktLoss="), PacketLoss);
+	FParse::Value(FCommandLine::Get(), TEXT("PktLag="), Lag);
+	FParse::Value(FCommandLine::Get(), TEXT("PktLagVariance="), LagVariance);
+
+	const TCHAR* Role = IsRunningDedicatedServer() ? TEXT("Server") : TEXT("Client");
+	UE_LOG(LogTemp, Log, TEXT("Net benchmark %s over %s (loss %.0f%%, lag %.0f ms, jitter %.0f ms), %.1f s - In %.2f KB/s, Out %.2f KB/s, %.2f us per packet, replication latency avg %.1f / p95 %.1f ms, %d corrections"),
+		Role, *Transport, PacketLoss, Lag, LagVariance, Seconds, InKBps, OutKBps, CpuUsPerPacket, LatencyAverage, LatencyP95, NumberOfCorrections);
+
+	// Same header in every file so the reports of a run can be concatenated
+	const FString Report = FString::Printf(TEXT("Role,Transport,PktLoss,PktLag,PktLagVariance,Seconds,InKBps,OutKBps,InPackets,OutPackets,InPacketsLost,OutPacketsLost,ReceiveUsPerPacket,SendUsPerPacket,CpuUsPerPacket,ReplicationLatencyAvgMs,ReplicationLatencyP95Ms,Corrections,CorrectionsPerSecond\n")
+		TEXT("%s,%s,%.1f,%.1f,%.1f,%.2f,%.3f,%.3f,%llu,%llu,%llu,%llu,%.3f,%.3f,%.3f,%.2f,%.2f,%d,%.3f\n"),
+		Role, *Transport, PacketLoss, Lag, LagVariance, Seconds, InKBps, OutKBps, InPackets, OutPackets,
+		LastCounters.InPacketsLost - FirstCounters.InPacketsLost, LastCounters.OutPacketsLost - FirstCounters.OutPacketsLost,
+		ReceiveUsPerPacket, SendUsPerPacket, CpuUsPerPacket, LatencyAverage, LatencyP95, NumberOfCorrections, NumberOfCorrections / Seconds);
+	if (!FFileHelper::SaveStringToFile(Report, *ReportPath)) {
+		UE_LOG(LogTemp, Warning, TEXT("Failed to write net benchmark report to %s !"), *ReportPath);
+	}
+}
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EOS_NetBenchSubsystem.generated.h"
+
+class UNetDriver;
+
+// Cumulative traffic of a net driver, since it was created
+struct FEOSNetBenchCounters
+{
+	uint64 InBytes = 0;
+	uint64 OutBytes = 0;
+	uint64 InPackets = 0;
+	uint64 OutPackets = 0;
+	uint64 InPacketsLost = 0;
+	uint64 OutPacketsLost = 0;
+
+	static FEOSNetBenchCounters Sample(const UNetDriver& NetDriver);
+};
+
+/**
+ * Transport benchmark (-NetBench), run by NetBench.sh on a dedicated server and its headless bots under the emulated
+ * loss, latency and jitter of -PktLoss=, -PktLag= and -PktLagVariance=. From the first connection and for
+ * -NetBenchDuration= seconds, measures the bandwidth, the time spent receiving and sending every packet, the replication
+ * latency of the other characters and the corrections of our own movement, then writes them to -NetBenchReport=.
+ * The server quits once its report is written.
+ */
+UCLASS()
+class EOSTUTORIAL_API UEOS_NetBenchSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// -NetBenchTransport=Ip runs the game net driver as its IpNetDriver fallback. Called before any net driver is created.
+	static void ApplyTransport();
+
+	// Server world time from a movement update of a simulated character to its arrival here, the clock offset corrected by half the round trip
+	void RecordReplicationLatency(float Milliseconds);
+
+	// The server corrected the movement of our character
+	void RecordCorrection();
+
+	// Log and write the measures of the window, once
+	void WriteReport();
+
+private:
+	void HandleWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaTime);
+	void HandlePostTickDispatch();
+	void HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime);
+	void HandlePostTickFlush();
+
+	bool IsWindowRunning() const { return WindowStartTime > 0.0 && !bHasWrittenReport; }
+
+	FString Transport;
+	FString ReportPath;
+	float Duration = 30.f;
+
+	double WindowStartTime = 0.0;
+	double LastSampleTime = 0.0;
+	FEOSNetBenchCounters FirstCounters; // When the window started
+	FEOSNetBenchCounters LastCounters;
+
+	double ReceiveStartTime = 0.0;
+	double SendStartTime = 0.0;
+	double ReceiveSeconds = 0.0; // Net drivers tick dispatch, where packets are received and processed
+	double SendSeconds = 0.0; // Net drivers tick flush, where actors are replicated and packets sent
+
+	TArray<float> ReplicationLatenciesMs;
+	int32 NumberOfCorrections = 0;
+	bool bHasWrittenReport = false;
+
+	FDelegateHandle WorldTickStartHandle;
+	FDelegateHandle PostTickDispatchHandle;
+	FDelegateHandle WorldPostActorTickHandle;
+	FDelegateHandle PostTickFlushHandle;
+};
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_PhaseTrace.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/MiscTrace.h"
+
+FEOSPhaseTrace::FEOSPhaseTrace(const TCHAR* InName, TArray<const TCHAR*>&& InPhaseNames)
+	: Name(InName), PhaseNames(MoveTemp(InPhaseNames)) {
+	PhaseTimes.Init(0.0, PhaseNames.Num());
+}
+
+bool FEOSPhaseTrace::Begin(double FirstPhaseTime) {
+	if (bIsRunning) {
+		return false;
+	}
+	bIsRunning = true;
+	RunId++;
+	PhaseTimes.Init(0.0, PhaseNames.Num());
+	if (FirstPhaseTime > 0.0 && PhaseTimes.Num() > 0) {
+		PhaseTimes[0] = FirstPhaseTime;
+	}
+	return true;
+}
+
+bool FEOSPhaseTrace::Mark(int32 Phase) {
+	if (!bIsRunning || !PhaseTimes.IsValidIndex(Phase) || PhaseTimes[Phase] > 0.0) {
+		return false;
+	}
+	PhaseTimes[Phase] = FPlatformTime::Seconds();
+	TRACE_BOOKMARK(TEXT("EOS %s %u - %s"), *Name, RunId, PhaseNames[Phase]);
+	return true;
+}
+
+double FEOSPhaseTrace::GetStartTime() const {
+	double StartTime = 0.0;
+	for (const double PhaseTime : PhaseTimes) {
+		if (PhaseTime > 0.0 && (StartTime <= 0.0 || PhaseTime < StartTime)) {
+			StartTime = PhaseTime;
+		}
+	}
+	return StartTime;
+}
+
+FString FEOSPhaseTrace::End() {
+	bIsRunning = false;
+
+	const double StartTime = GetStartTime();
+	FString Breakdown;
+	for (int32 Phase = 0; Phase < PhaseTimes.Num(); Phase++) {
+		if (PhaseTimes[Phase] > 0.0) {
+			Breakdown += FString::Printf(TEXT(" %s at %.1f ms,"), PhaseNames[Phase], (PhaseTimes[Phase] - StartTime) * 1000.0);
+		}
+	}
+	Breakdown.RemoveFromEnd(TEXT(","));
+	return Breakdown;
+}
+
+void FEOSPhaseTrace::AppendCsvLine(const FString& LeadingHeader, const FString& LeadingColumns) const {
+	const FString CsvPath = FPaths::ProjectLogDir() / FString::Printf(TEXT("%sTrace.csv"), *Name);
+	FString CsvLine;
+	if (!IFileManager::Get().FileExists(*CsvPath)) {
+		CsvLine += LeadingHeader;
+		for (const TCHAR* PhaseName : PhaseNames) {
+			CsvLine += FString::Printf(TEXT(",%s"), PhaseName);
+		}
+		CsvLine += TEXT("\n");
+	}
+
+	const double StartTime = GetStartTime();
+	CsvLine += LeadingColumns;
+	for (const double PhaseTime : PhaseTimes) {
+		CsvLine += PhaseTime > 0.0 ? FString::Printf(TEXT(",%.1f"), (PhaseTime - StartTime) * 1000.0) : FString(TEXT(",-1"));
+	}
+	CsvLine += TEXT("\n");
+	FFileHelper::SaveStringToFile(CsvLine, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
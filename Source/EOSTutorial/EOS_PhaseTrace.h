@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Timestamps the phases of one run of a multi step process, a join attempt or a server start, shared by
+ * FEOSJoinTrace and FEOSStartupTrace. Phases are shown as bookmarks in Insights ("EOS <Name> <RunId> - <Phase>").
+ * A finished run gives every phase reached as milliseconds since the first one, for the log and for a line of
+ * Saved/Logs/<Name>Trace.csv. Phases are recorded the first time only and don't have to be reached in order.
+ */
+class EOSTUTORIAL_API FEOSPhaseTrace
+{
+public:
+	FEOSPhaseTrace(const TCHAR* InName, TArray<const TCHAR*>&& InPhaseNames);
+
+	// Start a new run, false when one is already running. The first phase is recorded at FirstPhaseTime when given
+	bool Begin(double FirstPhaseTime = 0.0);
+
+	// Record a phase of the running run, false when it is not running or the phase was recorded already
+	bool Mark(int32 Phase);
+
+	// Stop the running run, returns " Phase at X ms," for every phase reached
+	FString End();
+
+	// Append a line to Saved/Logs/<Name>Trace.csv : the leading columns, then a column per phase, -1 for phases not reached
+	void AppendCsvLine(const FString& LeadingHeader, const FString& LeadingColumns) const;
+
+	bool IsRunning() const { return bIsRunning; }
+	uint32 GetRunId() const { return RunId; }
+
+	// Seconds, 0 for a phase not reached
+	double GetPhaseTime(int32 Phase) const { return PhaseTimes.IsValidIndex(Phase) ? PhaseTimes[Phase] : 0.0; }
+
+	// Time of the first phase reached, 0 for none
+	double GetStartTime() const;
+
+private:
+	FString Name;
+	TArray<const TCHAR*> PhaseNames;
+	TArray<double> PhaseTimes;
+	uint32 RunId = 0;
+	bool bIsRunning = false;
+};
@@ -8,6 +8,19 @@
 #include "Interfaces/OnlineIdentityInterface.h"
 #include "Interfaces/OnlineSessionInterface.h"
 #include "OnlineSessionSettings.h"
+#include "EOS_GameSession.h"
+#include "EOS_BotClient.h"
+#include "EOS_NetBenchSubsystem.h"
+#include "EOS_TelemetrySubsystem.h"
+#include "EOS_JoinTrace.h"
+#include "EOS_ActorPoolSubsystem.h"
+#include "EOS_ServerStreamingSubsystem.h"
+#include "EOSTutorialCharacter.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerState.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "TimerManager.h"
 
 // Default class constructor
 AEOS_PlayerController::AEOS_PlayerController()
@@ -18,9 +31,83 @@ AEOS_PlayerController::AEOS_PlayerController()
 void AEOS_PlayerController::BeginPlay()
 {
 	Super::BeginPlay(); // Call parent class BeginPlay
+
+	// The dedicated server streams around our pawn through UEOS_ServerStreamingSubsystem, with its margin and memory caps.
+	// Our own source would keep the plain loading range loaded around us whatever the subsystem drops
+	if (GetWorld()->GetSubsystem<UEOS_ServerStreamingSubsystem>()) {
+		bEnableStreamingSource = false;
+	}
+
+	// Bots don't log into EOS, their name stands in for an identity
+	if (FEOSBotSettings::Get().bIsEnabled) {
+		if (IsLocalController()) {
+			StartBot();
+		}
+		return;
+	}
+
+	// A join attempt starts on the startup map and ends with our pawn on the server map
+	if (IsLocalController() && GetWorld()->GetNetMode() == NM_Standalone) {
+		FEOSJoinTrace& JoinTrace = FEOSJoinTrace::Get();
+		if (JoinTrace.IsAttemptRunning()) {
+			JoinTrace.EndAttempt(TEXT("Abandoned"));
+		}
+		JoinTrace.BeginAttempt();
+		JoinTrace.MarkStage(EEOSJoinStage::BeginPlay);
+
+		// Load the server map in the background while we log in and search
+		if (UEOS_GameInstance* GameInstance = GetGameInstance<UEOS_GameInstance>()) {
+			GameInstance->PreloadServerMap();
+		}
+	}
+
 	Login(); // Login
 }
 
+void AEOS_PlayerController::OnPossess(APawn* InPawn)
+{
+	Super::OnPossess(InPawn);
+
+	if (UEOS_TelemetrySubsystem* Telemetry = GetWorld()->GetSubsystem<UEOS_TelemetrySubsystem>()) {
+		Telemetry->RecordPlayerSpawned(this);
+	}
+}
+
+void AEOS_PlayerController::PawnLeavingGame()
+{
+	UEOS_ActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UEOS_ActorPoolSubsystem>();
+	APawn* LeavingPawn = GetPawn();
+	if (!ActorPool || !LeavingPawn) {
+		Super::PawnLeavingGame();
+		return;
+	}
+
+	UnPossess();
+	ActorPool->ReleaseActor(LeavingPawn);
+}
+
+// Same as the base class, with a pooled player state instead of a new one
+void AEOS_PlayerController::InitPlayerState()
+{
+	UEOS_ActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UEOS_ActorPoolSubsystem>();
+	const AGameModeBase* GameMode = GetWorld()->GetAuthGameMode();
+	if (!ActorPool || !GameMode || !GameMode->PlayerStateClass) {
+		Super::InitPlayerState();
+		return;
+	}
+
+	FActorSpawnParameters SpawnInfo;
+	SpawnInfo.Owner = this;
+	SpawnInfo.Instigator = GetInstigator();
+	SpawnInfo.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnInfo.ObjectFlags |= RF_Transient;
+	PlayerState = ActorPool->AcquireActor<APlayerState>(GameMode->PlayerStateClass, FTransform::Identity, SpawnInfo);
+	// Like APlayerController::InitPlayerState, no SetPlayerName and its entry messages before the game mode picks the name
+	if (PlayerState && PlayerState->GetPlayerName().IsEmpty()) {
+		PlayerState->SetPlayerNameInternal(GameMode->DefaultPlayerName.ToString());
+	}
+}
+
 /*
 This function will access the EOS OSS via the OSS identity interface to log first into Epic Account Services, and then into Epic Game Services.
 It will bind a delegate to handle the callback event once login call succeeeds or fails.
@@ -38,9 +125,15 @@ void AEOS_PlayerController::Login()
 	// This can happen if your player travels to a dedicated server or different maps as BeginPlay() will be called each time.
 	FUniqueNetIdPtr NetId = Identity->GetUniquePlayerId(0);
 	if (NetId != nullptr && Identity->GetLoginStatus(0) == ELoginStatus::LoggedIn) {
+		// Back on a standalone map with a token already there, search right away
+		if (IsLocalController() && GetWorld()->GetNetMode() == NM_Standalone) {
+			FindSessions();
+		}
 		return;
 	}
 
+	FEOSJoinTrace::Get().MarkStage(EEOSJoinStage::Login);
+
 	// This binds a delegate so we can run our function when the callback completes. 0 represents the player number.
 	LoginDelegateHandle = Identity->AddOnLoginCompleteDelegate_Handle(0, FOnLoginCompleteDelegate::CreateUObject(this, &AEOS_PlayerController::HandleLoginCompleted));
 
@@ -56,6 +149,7 @@ void AEOS_PlayerController::Login()
 
 		if (!Identity->AutoLogin(0)) {
 			UE_LOG(LogTemp, Warning, TEXT("Failed to auto-login !"));
+			FEOSJoinTrace::Get().EndAttempt(TEXT("Login"));
 			Identity->ClearOnLoginCompleteDelegate_Handle(0, LoginDelegateHandle);
 			LoginDelegateHandle.Reset();
 		}
@@ -68,6 +162,7 @@ void AEOS_PlayerController::Login()
 
 		if (!Identity->Login(0, Credentials)) {
 			UE_LOG(LogTemp, Warning, TEXT("Failed to login !"));
+			FEOSJoinTrace::Get().EndAttempt(TEXT("Login"));
 			Identity->ClearOnLoginCompleteDelegate_Handle(0, LoginDelegateHandle);
 			LoginDelegateHandle.Reset();
 		}
@@ -84,95 +179,359 @@ void AEOS_PlayerController::HandleLoginCompleted(int32 LocalUserNum, bool bWasSu
 	IOnlineIdentityPtr Identity = Subsystem->GetIdentityInterface();
 	if (bWasSuccessful) {
 		UE_LOG(LogTemp, Log, TEXT("Login callback completed !"));
+		FEOSJoinTrace::Get().MarkStage(EEOSJoinStage::LoginCompleted);
 		FindSessions();
 	}
 	else {
 		UE_LOG(LogTemp, Warning, TEXT("EOS Login Failed !"));
+		FEOSJoinTrace::Get().EndAttempt(TEXT("LoginCompleted"));
 	}
 
 	Identity->ClearOnLoginCompleteDelegate_Handle(LocalUserNum, LoginDelegateHandle);
 	LoginDelegateHandle.Reset();
 }
 
-void AEOS_PlayerController::FindSessions(FName SearchKey, FString SearchValue)
+void AEOS_PlayerController::FindSessions()
 {
-	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
-	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
-	TSharedRef<FOnlineSessionSearch> Search = MakeShared<FOnlineSessionSearch>();
+	FEOSJoinTrace::Get().MarkStage(EEOSJoinStage::FindSessions);
 
-	// Remove the default settings that FOnlineSessionSearch set
-	Search->QuerySettings.SearchParams.Empty();
+	UEOS_GameInstance* GameInstance = GetGameInstance<UEOS_GameInstance>();
+	if (!GameInstance) {
+		UE_LOG(LogTemp, Warning, TEXT("Game instance is not a UEOS_GameInstance, can't find sessions !"));
+		return;
+	}
+	SessionOperations = GameInstance->GetSessionOperations();
 
-	// Search using key/value attributes
-	Search->QuerySettings.Set(SearchKey, SearchValue, EOnlineComparisonOp::Equals);
-	FindSessionsDelegateHandle = Session->AddOnFindSessionsCompleteDelegate_Handle(
-		FOnFindSessionsCompleteDelegate::CreateUObject(this, &AEOS_PlayerController::HandleFindSessionsCompleted, Search));
+	// Cached results are there right away, they are validated before we join them
+	CandidateSearchResults = GameInstance->GetCachedSearchResults();
+	bCandidatesFromCache = CandidateSearchResults.Num() > 0;
+	if (bCandidatesFromCache) {
+		UE_LOG(LogTemp, Log, TEXT("Using %d cached sessions"), CandidateSearchResults.Num());
+		JoinBestCandidate();
+		return;
+	}
 
-	UE_LOG(LogTemp, Log, TEXT("Finding sessions..."));
+	GameInstance->SearchSessions(GetSessionSearchKeys(), FOnEOSSessionSearchCompleted::CreateUObject(this, &AEOS_PlayerController::HandleFindSessionsCompleted));
+}
 
-	if (!Session->FindSessions(0, Search)) {
-		UE_LOG(LogTemp, Warning, TEXT("Failed to find session !"));
+TArray<FEOSSessionSearchKey> AEOS_PlayerController::GetSessionSearchKeys() const {
+	// Default to the attribute every server advertises
+	TArray<FEOSSessionSearchKey> SearchKeys = SessionSearchKeys;
+	if (SearchKeys.Num() == 0) {
+		FEOSSessionSearchKey DefaultSearchKey;
+		DefaultSearchKey.Key = "KeyName";
+		DefaultSearchKey.Value = "KeyValue";
+		SearchKeys.Add(DefaultSearchKey);
 	}
+	return SearchKeys;
 }
 
-void AEOS_PlayerController::HandleFindSessionsCompleted(bool bWasSuccesful, TSharedRef<FOnlineSessionSearch> Search) {
+void AEOS_PlayerController::HandleFindSessionsCompleted(const TArray<FOnlineSessionSearchResult>& SearchResults) {
+	CandidateSearchResults = SearchResults;
+	bCandidatesFromCache = false;
+	JoinBestCandidate();
+}
+
+void AEOS_PlayerController::JoinBestCandidate() {
+	FEOSJoinTrace::Get().MarkStage(EEOSJoinStage::FindSessionsCompleted);
+
 	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
 	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
 
-	if (bWasSuccesful) {
-		UE_LOG(LogTemp, Log, TEXT("Found sessions !"));
-
-		for (FOnlineSessionSearchResult SessionInSearchResult : Search->SearchResults) {
-			// Check if Session is valid => Currently a bug in EOS make IsValid() to always return false on DS so we skip this step
+	// Check if Session is valid => Currently a bug in EOS make IsValid() to always return false on DS so we skip this step
+	int32 BestIndex = INDEX_NONE;
+	float BestScore = 0.f;
+	for (int32 Index = 0; Index < CandidateSearchResults.Num(); ++Index) {
+		const FOnlineSessionSearchResult& SearchResult = CandidateSearchResults[Index];
+		const float Score = ScoreSearchResult(SearchResult);
+		FString ResolvedConnectString;
+		// Ensure the connection string is resolvable
+		if (Score >= 0.f && (BestIndex == INDEX_NONE || Score > BestScore) && Session->GetResolvedConnectString(SearchResult, NAME_GamePort, ResolvedConnectString)) {
+			BestIndex = Index;
+			BestScore = Score;
+			ConnectString = ResolvedConnectString;
+		}
+	}
 
-			// Ensure the connection string is resolvable and store the info in ConnectInfo and in SessionToJoin
-			if (Session->GetResolvedConnectString(SessionInSearchResult, NAME_GamePort, ConnectString)) {
-				SessionToJoin = &SessionInSearchResult;
+	if (BestIndex == INDEX_NONE) {
+		if (bCandidatesFromCache) {
+			// Every cached session went stale, fall back to a real search
+			UE_LOG(LogTemp, Log, TEXT("No cached session left, searching..."));
+			if (UEOS_GameInstance* GameInstance = GetGameInstance<UEOS_GameInstance>()) {
+				bCandidatesFromCache = false;
+				GameInstance->SearchSessions(GetSessionSearchKeys(), FOnEOSSessionSearchCompleted::CreateUObject(this, &AEOS_PlayerController::HandleFindSessionsCompleted));
+				return;
 			}
-
-			// Currently, just take the first session. TODO : Find the BEST session
-			break;
 		}
-		JoinSession();
+		UE_LOG(LogTemp, Warning, TEXT("No joinable session found !"));
+		FEOSJoinTrace::Get().EndAttempt(TEXT("NoSession"));
+		return;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Best session %s scored %.1f out of %d candidates"), *CandidateSearchResults[BestIndex].GetSessionIdStr(), BestScore, CandidateSearchResults.Num());
+	SessionToJoin = CandidateSearchResults[BestIndex];
+	CandidateSearchResults.RemoveAt(BestIndex);
+
+	if (bCandidatesFromCache) {
+		GetGameInstance<UEOS_GameInstance>()->ValidateSearchResult(SessionToJoin, FOnEOSSearchResultValidated::CreateUObject(this, &AEOS_PlayerController::HandleSessionToJoinValidated));
 	}
 	else {
-		UE_LOG(LogTemp, Warning, TEXT("Failed to find session ! (From Callback)"));
+		JoinSession();
 	}
-
-	Session->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsDelegateHandle);
-	FindSessionsDelegateHandle.Reset();
 }
 
-void AEOS_PlayerController::JoinSession() {
+void AEOS_PlayerController::HandleSessionToJoinValidated(bool bIsStillJoinable, const FOnlineSessionSearchResult& SearchResult) {
+	if (!bIsStillJoinable) {
+		UE_LOG(LogTemp, Log, TEXT("Cached session %s is gone or full, trying the next one"), *SearchResult.GetSessionIdStr());
+		JoinBestCandidate();
+		return;
+	}
+
+	// Join with the up to date copy, its connect string may have changed
+	SessionToJoin = SearchResult;
 	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
 	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
+	Session->GetResolvedConnectString(SessionToJoin, NAME_GamePort, ConnectString);
+	JoinSession();
+}
 
-	JoinSessionDelegateHandle = Session->AddOnJoinSessionCompleteDelegate_Handle(FOnJoinSessionCompleteDelegate::CreateUObject(this, &AEOS_PlayerController::HandleJoinSessionCompleted));
+float AEOS_PlayerController::ScoreSearchResult(const FOnlineSessionSearchResult& SearchResult) const {
+	const int32 NumberOfSlots = SearchResult.Session.SessionSettings.NumPublicConnections;
+	const int32 NumberOfOpenSlots = SearchResult.Session.NumOpenPublicConnections;
+	if (NumberOfSlots <= 0 || NumberOfOpenSlots <= 0) {
+		return -1.f; // Full session
+	}
 
-	UE_LOG(LogTemp, Log, TEXT("Joining Session..."));
-	if (!Session->JoinSession(0, "SessionName", *SessionToJoin)) {
-		UE_LOG(LogTemp, Warning, TEXT("Join Session Failed !"));
+	// Fill the fullest viable match first so matches start as soon as possible
+	float Score = SessionScoreFillWeight * (NumberOfSlots - NumberOfOpenSlots) / NumberOfSlots;
+
+	// Unknown ping is reported as MAX_QUERY_PING, don't penalize it
+	if (SearchResult.PingInMs > 0 && SearchResult.PingInMs < MAX_QUERY_PING) {
+		Score -= SessionScorePingWeight * SearchResult.PingInMs;
 	}
+
+	FString ServerRegion;
+	if (!PreferredRegion.IsEmpty() && SearchResult.Session.SessionSettings.Get(SETTING_SERVERREGION, ServerRegion) && ServerRegion == PreferredRegion) {
+		Score += SessionScoreRegionBonus;
+	}
+
+	// Joinable sessions score zero or more, negative scores are kept for full sessions
+	return FMath::Max(Score, 0.f);
+}
+
+void AEOS_PlayerController::JoinSession() {
+	UE_LOG(LogTemp, Log, TEXT("Joining Session..."));
+	FEOSJoinTrace::Get().MarkStage(EEOSJoinStage::JoinSession);
+	SessionOperations->JoinSession(0, "SessionName", SessionToJoin, FOnEOSSessionOperationCompleted::CreateUObject(this, &AEOS_PlayerController::HandleJoinSessionCompleted, FName("SessionName")));
 }
 
-void AEOS_PlayerController::HandleJoinSessionCompleted(FName SessionName, EOnJoinSessionCompleteResult::Type Result) {
+void AEOS_PlayerController::HandleJoinSessionCompleted(EEOSSessionOperationResult Result, FName SessionName) {
 	IOnlineSubsystem* Subsystem = Online::GetSubsystem(GetWorld());
 	IOnlineSessionPtr Session = Subsystem->GetSessionInterface();
 
-	if (Result == EOnJoinSessionCompleteResult::Success) {
+	if (Result == EEOSSessionOperationResult::Success) {
 		UE_LOG(LogTemp, Log, TEXT("Joined Session !"));
+		FEOSJoinTrace::Get().MarkStage(EEOSJoinStage::JoinSessionCompleted);
+		if (UEOS_GameInstance* GameInstance = GetGameInstance<UEOS_GameInstance>()) {
+			GameInstance->StopSearchCacheRefresh();
+		}
 		if (GEngine) {
-			ConnectString = "127.0.0.1:7777"; // Override Connect String to localhost for development purpose
+			// Servers sharing a machine advertise their own address and port, the resolved connect string is used otherwise
+			FString HostedSessionName;
+			FString ServerAddress;
+			FNamedOnlineSession* JoinedSession = Session->GetNamedSession(SessionName);
+			if (JoinedSession && JoinedSession->SessionSettings.Get(SETTING_SERVERADDRESS, ServerAddress) && !ServerAddress.IsEmpty()) {
+				ConnectString = ServerAddress;
+			}
+			if (ConnectString.IsEmpty()) {
+				UE_LOG(LogTemp, Error, TEXT("Joined session has no address to connect to !"));
+				FEOSJoinTrace::Get().EndAttempt(TEXT("Browse"));
+				return;
+			}
+
+			// Tell the server which of its hosted sessions we joined so it routes us to the right match
+			if (JoinedSession && JoinedSession->SessionSettings.Get(SETTING_HOSTEDSESSION, HostedSessionName)) {
+				ConnectString += FString::Printf(TEXT("?%s=%s"), *SETTING_HOSTEDSESSION.ToString(), *HostedSessionName);
+			}
+
+			FEOSJoinTrace::Get().MarkStage(EEOSJoinStage::Browse);
 			FURL DedicatedServerURL(nullptr, *ConnectString, TRAVEL_Absolute);
 			FString DedicatedServerJoinError;
 			EBrowseReturnVal::Type DedicatedServerJoinStatus = GEngine->Browse(GEngine->GetWorldContextFromWorldChecked(GetWorld()), DedicatedServerURL, DedicatedServerJoinError);
 			if (DedicatedServerJoinStatus == EBrowseReturnVal::Failure) {
 				UE_LOG(LogTemp, Error, TEXT("Failed to browse for dedicated server. Error is: %s"), *DedicatedServerJoinError);
+				FEOSJoinTrace::Get().EndAttempt(TEXT("Browse"));
 			}
 
 			// No check of NetworkError or TravelError events
 		}
 	}
-	Session->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionDelegateHandle);
-	JoinSessionDelegateHandle.Reset();
+	else {
+		UE_LOG(LogTemp, Warning, TEXT("Join Session Failed !"));
+		FEOSJoinTrace::Get().EndAttempt(TEXT("JoinSession"));
+	}
+}
+
+void AEOS_PlayerController::StartBot() {
+	const FEOSBotSettings& BotSettings = FEOSBotSettings::Get();
+
+	// Nothing to look at, save the rendering time even if -nullrhi wasn't passed
+	if (UGameViewportClient* GameViewport = GetWorld()->GetGameViewport()) {
+		GameViewport->bDisableWorldRendering = true;
+	}
+
+	// Still on the startup map, connect to the server
+	if (GetWorld()->GetNetMode() == NM_Standalone) {
+		// The other bots of the process are local players, they join through our connection once we are in
+		UGameInstance* GameInstance = GetGameInstance();
+		if (UGameViewportClient* GameViewport = GetWorld()->GetGameViewport()) {
+			GameViewport->MaxSplitscreenPlayers = FMath::Max(GameViewport->MaxSplitscreenPlayers, BotSettings.BotsPerProcess);
+		}
+		while (GameInstance->GetNumLocalPlayers() < BotSettings.BotsPerProcess) {
+			FString LocalPlayerError;
+			if (!GameInstance->CreateLocalPlayer(GameInstance->GetNumLocalPlayers(), LocalPlayerError, false)) {
+				UE_LOG(LogTemp, Error, TEXT("Failed to add bot %d : %s"), BotSettings.BotId + GameInstance->GetNumLocalPlayers(), *LocalPlayerError);
+				break;
+			}
+		}
+
+		// Every bot stands in for an EOS login with a Null id, sent to the server with its join
+		const double ConnectStartTime = FPlatformTime::Seconds();
+		for (int32 LocalPlayerIndex = 0; LocalPlayerIndex < GameInstance->GetNumLocalPlayers(); LocalPlayerIndex++) {
+			const int32 BotId = BotSettings.BotId + LocalPlayerIndex;
+			GameInstance->GetLocalPlayerByIndex(LocalPlayerIndex)->SetCachedUniqueNetId(FUniqueNetIdRepl(FEOSBotSettings::CreateBotUserId(BotId)));
+			FEOSBotStats::Get(BotId).ConnectStartTime = ConnectStartTime;
+		}
+
+		ConnectString = FString::Printf(TEXT("%s?Name=Bot_%d"), *BotSettings.ServerAddress, BotSettings.BotId);
+		UE_LOG(LogTemp, Log, TEXT("%d bot(s) connecting to %s..."), GameInstance->GetNumLocalPlayers(), *ConnectString);
+
+		FURL DedicatedServerURL(nullptr, *ConnectString, TRAVEL_Absolute);
+		FString DedicatedServerJoinError;
+		if (GEngine->Browse(GEngine->GetWorldContextFromWorldChecked(GetWorld()), DedicatedServerURL, DedicatedServerJoinError) == EBrowseReturnVal::Failure) {
+			UE_LOG(LogTemp, Error, TEXT("Bot failed to browse for dedicated server. Error is: %s"), *DedicatedServerJoinError);
+		}
+		return;
+	}
+
+	// Every bot plays the same script for a given id, so runs can be compared
+	const int32 BotId = GetBotId();
+	BotRandomStream.Initialize(BotId);
+	ChangeBotInput();
+	GetWorldTimerManager().SetTimer(BotInputTimerHandle, this, &AEOS_PlayerController::ChangeBotInput, BotSettings.InputChangeInterval, true);
+	GetWorldTimerManager().SetTimer(BotStatsTimerHandle, this, &AEOS_PlayerController::SampleBotStats, BotSettings.StatsInterval, true);
+
+	// The first bot keeps the time of the whole process
+	if (BotSettings.Duration > 0.f && BotId == BotSettings.BotId) {
+		GetWorldTimerManager().SetTimer(BotDurationTimerHandle, this, &AEOS_PlayerController::FinishBot, BotSettings.Duration, false);
+	}
+}
+
+int32 AEOS_PlayerController::GetBotId() const {
+	const ULocalPlayer* LocalPlayer = GetLocalPlayer();
+	const UGameInstance* GameInstance = GetGameInstance();
+	const int32 LocalPlayerIndex = LocalPlayer && GameInstance ? GameInstance->GetLocalPlayers().IndexOfByKey(LocalPlayer) : 0;
+	return FEOSBotSettings::Get().BotId + FMath::Max(LocalPlayerIndex, 0);
+}
+
+void AEOS_PlayerController::AcknowledgePossession(APawn* P) {
+	Super::AcknowledgePossession(P);
+
+	// First pawn on the server map ends the join attempt
+	if (GetWorld()->GetNetMode() == NM_Client) {
+		FEOSJoinTrace::Get().MarkStage(EEOSJoinStage::InGame);
+		FEOSJoinTrace::Get().EndAttempt();
+
+		if (UEOS_GameInstance* GameInstance = GetGameInstance<UEOS_GameInstance>()) {
+			GameInstance->ReleasePreloadedAssets();
+		}
+	}
+
+	if (!FEOSBotSettings::Get().bIsEnabled) {
+		return;
+	}
+
+	FEOSBotStats& BotStats = FEOSBotStats::Get(GetBotId());
+	if (BotStats.JoinLatencyMs < 0.f && BotStats.ConnectStartTime > 0.0) {
+		BotStats.JoinLatencyMs = (FPlatformTime::Seconds() - BotStats.ConnectStartTime) * 1000.0;
+		UE_LOG(LogTemp, Log, TEXT("Bot %d joined in %.1f ms"), GetBotId(), BotStats.JoinLatencyMs);
+	}
+
+	// Once the first bot is in, the other bots of the process ask the server for their own player controller
+	if (GetWorld()->GetNetMode() == NM_Client && GetBotId() == FEOSBotSettings::Get().BotId) {
+		for (ULocalPlayer* LocalPlayer : GetGameInstance()->GetLocalPlayers()) {
+			if (LocalPlayer && !LocalPlayer->PlayerController) {
+				TArray<FString> SplitJoinOptions;
+				LocalPlayer->SendSplitJoin(SplitJoinOptions);
+			}
+		}
+	}
+}
+
+void AEOS_PlayerController::PlayerTick(float DeltaTime) {
+	// Before the input is processed, so the bot input is flushed with this frame
+	if (FEOSBotSettings::Get().bIsEnabled) {
+		if (AEOSTutorialCharacter* BotCharacter = Cast<AEOSTutorialCharacter>(GetPawn())) {
+			BotCharacter->ApplyScriptedInput(BotMovementVector, BotLookRate * DeltaTime);
+		}
+	}
+
+	Super::PlayerTick(DeltaTime);
+}
+
+void AEOS_PlayerController::PostProcessInput(const float DeltaTime, const bool bGamePaused) {
+	Super::PostProcessInput(DeltaTime, bGamePaused);
+
+	if (AEOSTutorialCharacter* InputCharacter = Cast<AEOSTutorialCharacter>(GetPawn())) {
+		InputCharacter->FlushCoalescedInput();
+	}
+}
+
+void AEOS_PlayerController::ChangeBotInput() {
+	BotMovementVector = FVector2D(BotRandomStream.FRandRange(-1.f, 1.f), BotRandomStream.FRandRange(-1.f, 1.f)).GetSafeNormal();
+	BotLookRate = FVector2D(BotRandomStream.FRandRange(-90.f, 90.f), BotRandomStream.FRandRange(-10.f, 10.f));
+
+	ACharacter* BotCharacter = GetCharacter();
+	if (BotCharacter && BotRandomStream.FRand() < FEOSBotSettings::Get().JumpChance) {
+		BotCharacter->Jump();
+	}
+	else if (BotCharacter) {
+		BotCharacter->StopJumping();
+	}
+}
+
+void AEOS_PlayerController::SampleBotStats() {
+	ServerBotPing(FPlatformTime::Seconds());
+	if (PlayerState) {
+		FEOSBotStats::Get(GetBotId()).PingsMs.Add(PlayerState->GetPingInMilliseconds());
+	}
+}
+
+void AEOS_PlayerController::ServerBotPing_Implementation(double ClientTime) {
+	// Server stats are for load tests only, anyone could send this RPC
+	if (FEOSBotSettings::Get().bAreBotsAllowed) {
+		ClientBotPong(ClientTime, FApp::GetDeltaTime() * 1000.0, GetWorld()->GetNumPlayerControllers());
+	}
+}
+
+void AEOS_PlayerController::ClientBotPong_Implementation(double ClientTime, float ServerFrameTimeMs, int32 NumberOfServerPlayers) {
+	FEOSBotStats& BotStats = FEOSBotStats::Get(GetBotId());
+	BotStats.RoundTripTimesMs.Add((FPlatformTime::Seconds() - ClientTime) * 1000.0);
+	BotStats.ServerFrameTimesMs.Add(ServerFrameTimeMs);
+	BotStats.MaxNumberOfServerPlayers = FMath::Max(BotStats.MaxNumberOfServerPlayers, NumberOfServerPlayers);
+}
+
+void AEOS_PlayerController::FinishBot() {
+	GetWorldTimerManager().ClearTimer(BotInputTimerHandle);
+	GetWorldTimerManager().ClearTimer(BotStatsTimerHandle);
+
+	// Bots the server turned away report too, with no join latency
+	const FEOSBotSettings& BotSettings = FEOSBotSettings::Get();
+	for (int32 BotId = BotSettings.BotId; BotId < BotSettings.BotId + BotSettings.BotsPerProcess; BotId++) {
+		FEOSBotStats::Get(BotId).WriteReport(BotId, BotSettings);
+	}
+	if (UEOS_NetBenchSubsystem* NetBench = GetWorld()->GetSubsystem<UEOS_NetBenchSubsystem>()) {
+		NetBench->WriteReport();
+	}
+	FPlatformMisc::RequestExit(false);
 }
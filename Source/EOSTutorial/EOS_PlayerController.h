@@ -5,6 +5,9 @@
 #include "CoreMinimal.h"
 #include "GameFramework/PlayerController.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "OnlineSessionSettings.h"
+#include "EOS_SessionOperations.h"
+#include "EOS_GameInstance.h"
 #include "EOS_PlayerController.generated.h"
 
 /**
@@ -25,6 +28,21 @@ protected:
 	// Function called when play begins
 	virtual void BeginPlay();
 
+	virtual void PlayerTick(float DeltaTime) override;
+
+	// Applies the input the character coalesced while the input stack was processed
+	virtual void PostProcessInput(const float DeltaTime, const bool bGamePaused) override;
+
+	virtual void AcknowledgePossession(APawn* P) override;
+
+	// Server side, reports the join to spawn latency
+	virtual void OnPossess(APawn* InPawn) override;
+
+	// Server side, the pawn and player state of a leaving player go back to the actor pool instead of being destroyed.
+	// The player state parks itself in AEOS_PlayerState::OnDeactivated, called by CleanupPlayerState
+	virtual void PawnLeavingGame() override;
+	virtual void InitPlayerState() override;
+
 	// Function to log in to EOS Game Services
 	void Login();
 
@@ -34,19 +52,79 @@ protected:
 	// Delegate to bind callback event for login
 	FDelegateHandle LoginDelegateHandle;
 
-	void FindSessions(FName SearchKey = "KeyName", FString SearchValue = "KeyValue");
+	// Join the best session the game instance has cached, or run one search per entry of SessionSearchKeys and join the best session found by any of them
+	void FindSessions();
+
+	void HandleFindSessionsCompleted(const TArray<FOnlineSessionSearchResult>& SearchResults);
+
+	// Pick the best remaining candidate and join it - Cached candidates are validated first
+	void JoinBestCandidate();
+
+	void HandleSessionToJoinValidated(bool bIsStillJoinable, const FOnlineSessionSearchResult& SearchResult);
+
+	// Higher is better. Fuller sessions, lower ping and our preferred region score higher. Returns a negative score for sessions we can't join.
+	float ScoreSearchResult(const FOnlineSessionSearchResult& SearchResult) const;
+
+	// SessionSearchKeys, or the attribute every server advertises if none is configured
+	TArray<FEOSSessionSearchKey> GetSessionSearchKeys() const;
+
+	UPROPERTY(Config)
+	TArray<FEOSSessionSearchKey> SessionSearchKeys;
 
-	void HandleFindSessionsCompleted(bool bWasSuccessful, TSharedRef<FOnlineSessionSearch> Search);
+	// Region we'd rather play in, matched against the region advertised by servers
+	UPROPERTY(Config)
+	FString PreferredRegion;
 
-	FDelegateHandle FindSessionsDelegateHandle;
+	// Weights used to score search results
+	UPROPERTY(Config)
+	float SessionScoreFillWeight = 100.f; // Applied to the ratio of taken slots, to land in the fullest match
+
+	UPROPERTY(Config)
+	float SessionScorePingWeight = 0.1f; // Removed per millisecond of ping
+
+	UPROPERTY(Config)
+	float SessionScoreRegionBonus = 50.f;
+
+	TArray<FOnlineSessionSearchResult> CandidateSearchResults; // Sessions not tried yet for the current FindSessions call
+	bool bCandidatesFromCache = false; // Candidates came from the search cache and may be stale
+
+	// Find and Join go through the session operation queue of the game instance, shared with its search cache
+	TSharedPtr<FEOSSessionOperations> SessionOperations;
 
 	FString ConnectString;
 
-	FOnlineSessionSearchResult* SessionToJoin;
+	FOnlineSessionSearchResult SessionToJoin; // Copy of the chosen search result, search results don't outlive their search
 
 	void JoinSession();
 
-	void HandleJoinSessionCompleted(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
+	void HandleJoinSessionCompleted(EEOSSessionOperationResult Result, FName SessionName);
+
+	// Headless bot mode (-EOSBot) - Connect straight to the server with every bot of the process, or start the input script and stats once there
+	void StartBot();
+
+	// Id of the bot driving this controller : the first bot id of the process plus the index of our local player
+	int32 GetBotId() const;
+
+	// Pick the next scripted Move / Look input, and maybe jump
+	void ChangeBotInput();
+
+	// Send a timestamped RPC to the server and sample our ping
+	void SampleBotStats();
+
+	// Write the report of every bot of the process and quit, the swarm script waits for every bot process
+	void FinishBot();
+
+	// Only answered by a server started with -AllowBots, which is never parsed in shipping builds
+	UFUNCTION(Server, Unreliable)
+	void ServerBotPing(double ClientTime);
+
+	UFUNCTION(Client, Unreliable)
+	void ClientBotPong(double ClientTime, float ServerFrameTimeMs, int32 NumberOfServerPlayers);
 
-	FDelegateHandle JoinSessionDelegateHandle;
+	FRandomStream BotRandomStream;
+	FVector2D BotMovementVector = FVector2D::ZeroVector;
+	FVector2D BotLookRate = FVector2D::ZeroVector; // Look input per second, scaled by the frame time
+	FTimerHandle BotInputTimerHandle;
+	FTimerHandle BotStatsTimerHandle;
+	FTimerHandle BotDurationTimerHandle;
 };
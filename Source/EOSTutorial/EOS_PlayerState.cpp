@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_PlayerState.h"
+#include "EOS_ActorPoolSubsystem.h"
+
+void AEOS_PlayerState::OnDeactivated() {
+	UEOS_ActorPoolSubsystem* ActorPool = GetWorld()->GetSubsystem<UEOS_ActorPoolSubsystem>();
+	if (!ActorPool) {
+		Super::OnDeactivated();
+		return;
+	}
+
+	ActorPool->ReleaseActor(this);
+}
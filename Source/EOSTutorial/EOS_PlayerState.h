@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerState.h"
+#include "EOS_PlayerState.generated.h"
+
+/**
+ * Player state handed out by the dedicated server actor pool, see AEOS_PlayerController::InitPlayerState
+ */
+UCLASS()
+class EOSTUTORIAL_API AEOS_PlayerState : public APlayerState
+{
+	GENERATED_BODY()
+
+protected:
+	// Its player left, parked in the actor pool instead of destroyed when there is one
+	virtual void OnDeactivated() override;
+};
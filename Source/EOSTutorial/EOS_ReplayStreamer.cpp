@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_ReplayStreamer.h"
+#include "Misc/Compression.h"
+
+bool FEOSReplayStreamer::CompressBuffer(const TArray<uint8>& InBuffer, TArray<uint8>& OutCompressed) const {
+	const int32 UncompressedSize = InBuffer.Num();
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Oodle, UncompressedSize);
+	OutCompressed.SetNumUninitialized(sizeof(int32) + CompressedSize);
+	FMemory::Memcpy(OutCompressed.GetData(), &UncompressedSize, sizeof(int32));
+	if (!FCompression::CompressMemory(NAME_Oodle, OutCompressed.GetData() + sizeof(int32), CompressedSize, InBuffer.GetData(), UncompressedSize)) {
+		UE_LOG(LogTemp, Warning, TEXT("Failed to compress a %d bytes replay buffer !"), UncompressedSize);
+		return false;
+	}
+	OutCompressed.SetNum(sizeof(int32) + CompressedSize, false);
+	return true;
+}
+
+bool FEOSReplayStreamer::DecompressBuffer(const TArray<uint8>& InCompressed, TArray<uint8>& OutBuffer) const {
+	int32 UncompressedSize = -1;
+	if (InCompressed.Num() >= sizeof(int32)) {
+		FMemory::Memcpy(&UncompressedSize, InCompressed.GetData(), sizeof(int32));
+	}
+	if (UncompressedSize < 0) {
+		UE_LOG(LogTemp, Warning, TEXT("Invalid compressed replay buffer !"));
+		return false;
+	}
+
+	OutBuffer.SetNumUninitialized(UncompressedSize);
+	return FCompression::UncompressMemory(NAME_Oodle, OutBuffer.GetData(), UncompressedSize, InCompressed.GetData() + sizeof(int32), InCompressed.Num() - sizeof(int32));
+}
@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LocalFileNetworkReplayStreaming.h"
+
+/**
+ * Local file replay streamer writing Oodle compressed stream chunks, checkpoints and events.
+ * The engine streamer keeps its chunking, bounded memory and checkpoint index, it only asks for the compression.
+ * Every compressed buffer starts with its uncompressed size.
+ */
+class FEOSReplayStreamer : public FLocalFileNetworkReplayStreamer
+{
+public:
+	virtual bool SupportsCompression() const override { return true; }
+	virtual bool CompressBuffer(const TArray<uint8>& InBuffer, TArray<uint8>& OutCompressed) const override;
+	virtual bool DecompressBuffer(const TArray<uint8>& InCompressed, TArray<uint8>& OutBuffer) const override;
+};
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_ReplicationGraph.h"
+#include "ReplicationGraphTypes.h"
+#include "Engine/LevelScriptActor.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "UObject/UObjectIterator.h"
+
+void UEOS_ReplicationGraph::InitGlobalActorClassSettings() {
+	Super::InitGlobalActorClassSettings();
+
+	// Actors gathered by the nodes themselves, the always relevant node of a connection handles its player controller
+	ClassRepNodePolicies.Set(APlayerState::StaticClass(), EEOSClassRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(APlayerController::StaticClass(), EEOSClassRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(ALevelScriptActor::StaticClass(), EEOSClassRepNodeMapping::NotRouted);
+
+	// Characters move all the time, no need to track their dormancy
+	ClassRepNodePolicies.Set(ACharacter::StaticClass(), EEOSClassRepNodeMapping::Spatialize_Dynamic);
+
+	// The graph is frame based, turn every replicated class settings into replication periods and cull distances
+	for (TObjectIterator<UClass> It; It; ++It) {
+		UClass* Class = *It;
+		const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject(false));
+		if (!ActorCDO || !ActorCDO->GetIsReplicated()) {
+			continue;
+		}
+
+		// Skip blueprint compilation leftovers
+		if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_"))) {
+			continue;
+		}
+
+		FClassReplicationInfo ClassInfo;
+		ClassInfo.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(ActorCDO->NetUpdateFrequency);
+		const EEOSClassRepNodeMapping Policy = GetMappingPolicy(Class);
+		if (Policy == EEOSClassRepNodeMapping::Spatialize_Static || Policy == EEOSClassRepNodeMapping::Spatialize_Dynamic || Policy == EEOSClassRepNodeMapping::Spatialize_Dormancy) {
+			ClassInfo.SetCullDistanceSquared(ActorCDO->NetCullDistanceSquared);
+		}
+		else {
+			ClassInfo.SetCullDistanceSquared(0.f);
+		}
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	}
+}
+
+EEOSClassRepNodeMapping UEOS_ReplicationGraph::GetMappingPolicy(UClass* Class) {
+	if (const EEOSClassRepNodeMapping* Policy = ClassRepNodePolicies.Get(Class)) {
+		return *Policy;
+	}
+
+	const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject(false));
+	if (!ActorCDO) {
+		return EEOSClassRepNodeMapping::NotRouted;
+	}
+	if (ActorCDO->bAlwaysRelevant) {
+		return EEOSClassRepNodeMapping::RelevantAllConnections;
+	}
+	if (ActorCDO->bOnlyRelevantToOwner) {
+		return EEOSClassRepNodeMapping::OwnerOnly;
+	}
+
+	const USceneComponent* RootComponent = ActorCDO->GetRootComponent();
+	if (RootComponent && RootComponent->Mobility == EComponentMobility::Static) {
+		return EEOSClassRepNodeMapping::Spatialize_Static;
+	}
+	return EEOSClassRepNodeMapping::Spatialize_Dormancy;
+}
+
+void UEOS_ReplicationGraph::InitGlobalGraphNodes() {
+	DestructInfoMaxDistanceSquared = FMath::Square(DestructionInfoMaxDistance);
+
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = FVector2D(SpatialBiasX, SpatialBiasY);
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+
+	// Replicates a few player states per frame instead of all of them, every frame, to everyone
+	PlayerStateNode = CreateNewNode<UReplicationGraphNode_PlayerStateFrequencyLimiter>();
+	AddGlobalGraphNode(PlayerStateNode);
+}
+
+void UEOS_ReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) {
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* AlwaysRelevantNodeForConnection = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(AlwaysRelevantNodeForConnection, RepGraphConnection);
+	AlwaysRelevantForConnectionList.Emplace(RepGraphConnection->NetConnection, AlwaysRelevantNodeForConnection);
+}
+
+void UEOS_ReplicationGraph::RemoveClientConnection(UNetConnection* NetConnection) {
+	AlwaysRelevantForConnectionList.RemoveAll([NetConnection](const FEOSConnectionAlwaysRelevantNodePair& Pair) { return Pair.NetConnection == NetConnection; });
+	Super::RemoveClientConnection(NetConnection);
+}
+
+UReplicationGraphNode_AlwaysRelevant_ForConnection* UEOS_ReplicationGraph::GetAlwaysRelevantNodeForConnection(UNetConnection* Connection) {
+	const FEOSConnectionAlwaysRelevantNodePair* Pair = Connection ? AlwaysRelevantForConnectionList.FindByKey(Connection) : nullptr;
+	return Pair ? Pair->Node.Get() : nullptr;
+}
+
+void UEOS_ReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) {
+	switch (GetMappingPolicy(ActorInfo.Class)) {
+	case EEOSClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+	case EEOSClassRepNodeMapping::OwnerOnly:
+		// The owner is often set after the actor starts replicating, routed in ServerReplicateActors
+		ActorsWithoutNetConnection.Add(ActorInfo.Actor);
+		break;
+	case EEOSClassRepNodeMapping::Spatialize_Static:
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+		break;
+	case EEOSClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+	case EEOSClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+	default:
+		break;
+	}
+}
+
+void UEOS_ReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) {
+	switch (GetMappingPolicy(ActorInfo.Class)) {
+	case EEOSClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		SetActorDestructionInfoToIgnoreDistanceCulling(ActorInfo.GetActor());
+		break;
+	case EEOSClassRepNodeMapping::OwnerOnly:
+		if (UReplicationGraphNode_AlwaysRelevant_ForConnection* Node = GetAlwaysRelevantNodeForConnection(ActorInfo.Actor->GetNetConnection())) {
+			Node->NotifyRemoveNetworkActor(ActorInfo);
+		}
+		ActorsWithoutNetConnection.Remove(ActorInfo.Actor);
+		break;
+	case EEOSClassRepNodeMapping::Spatialize_Static:
+		GridNode->RemoveActor_Static(ActorInfo);
+		break;
+	case EEOSClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+	case EEOSClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+	default:
+		break;
+	}
+}
+
+int32 UEOS_ReplicationGraph::ServerReplicateActors(float DeltaSeconds) {
+	// Route owner only actors that got their connection since last frame
+	for (int32 Index = ActorsWithoutNetConnection.Num() - 1; Index >= 0; Index--) {
+		AActor* Actor = ActorsWithoutNetConnection[Index];
+		if (!Actor) {
+			ActorsWithoutNetConnection.RemoveAtSwap(Index, 1, false);
+		}
+		else if (UNetConnection* Connection = Actor->GetNetConnection()) {
+			if (UReplicationGraphNode_AlwaysRelevant_ForConnection* Node = GetAlwaysRelevantNodeForConnection(Connection)) {
+				Node->NotifyAddNetworkActor(FNewReplicatedActorInfo(Actor));
+			}
+			ActorsWithoutNetConnection.RemoveAtSwap(Index, 1, false);
+		}
+	}
+
+	return Super::ServerReplicateActors(DeltaSeconds);
+}
+
+void UEOS_ReplicationGraph::SetActorReplicationFrequency(AActor* Actor, float Frequency) {
+	if (FGlobalActorReplicationInfo* GlobalInfo = GlobalActorReplicationInfoMap.Find(Actor)) {
+		GlobalInfo->Settings.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(Frequency);
+	}
+}
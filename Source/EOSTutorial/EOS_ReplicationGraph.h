@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "EOS_ReplicationGraph.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+class UReplicationGraphNode_AlwaysRelevant_ForConnection;
+class UReplicationGraphNode_PlayerStateFrequencyLimiter;
+
+// How actors of a class are routed to the graph nodes
+enum class EEOSClassRepNodeMapping : uint8 {
+	NotRouted, // Gathered by a node on its own, like player states
+	RelevantAllConnections, // Always relevant actors, like the game state
+	OwnerOnly, // Only relevant to their owner, like player controllers
+	Spatialize_Static, // Never moves, put in the grid cells once
+	Spatialize_Dynamic, // Moves every frame, like characters, re-gridded every frame
+	Spatialize_Dormancy // Moves until it goes dormant, treated as static while dormant
+};
+
+// Always relevant node of a connection, owner only actors of that connection go there
+USTRUCT()
+struct FEOSConnectionAlwaysRelevantNodePair
+{
+	GENERATED_BODY()
+
+	FEOSConnectionAlwaysRelevantNodePair() { }
+	FEOSConnectionAlwaysRelevantNodePair(UNetConnection* InConnection, UReplicationGraphNode_AlwaysRelevant_ForConnection* InNode) : NetConnection(InConnection), Node(InNode) { }
+	bool operator==(const UNetConnection* InConnection) const { return InConnection == NetConnection; }
+
+	UPROPERTY()
+	TObjectPtr<UNetConnection> NetConnection = nullptr;
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_AlwaysRelevant_ForConnection> Node = nullptr;
+};
+
+/**
+ * Replication graph of the dedicated server - Characters live in a 2D spatial grid so every connection
+ * only considers the actors of the cells around its viewer, instead of every actor of the world.
+ * Always relevant actors are gathered once for every connection, owner only actors in a node per connection.
+ */
+UCLASS(transient, config=Engine)
+class EOSTUTORIAL_API UEOS_ReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RemoveClientConnection(UNetConnection* NetConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	// Replicate an actor at another rate than its class, NetUpdateFrequency is only read when it is added
+	void SetActorReplicationFrequency(AActor* Actor, float Frequency);
+
+private:
+	EEOSClassRepNodeMapping GetMappingPolicy(UClass* Class);
+
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* GetAlwaysRelevantNodeForConnection(UNetConnection* Connection);
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_GridSpatialization2D> GridNode;
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_ActorList> AlwaysRelevantNode;
+
+	UPROPERTY()
+	TObjectPtr<UReplicationGraphNode_PlayerStateFrequencyLimiter> PlayerStateNode;
+
+	UPROPERTY()
+	TArray<FEOSConnectionAlwaysRelevantNodePair> AlwaysRelevantForConnectionList;
+
+	// Owner only actors spawned before they had a connection, routed as soon as they get one
+	UPROPERTY()
+	TArray<TObjectPtr<AActor>> ActorsWithoutNetConnection;
+
+	TClassMap<EEOSClassRepNodeMapping> ClassRepNodePolicies;
+
+	// Size of a grid cell, should be close to the net cull distance of characters
+	UPROPERTY(Config)
+	float GridCellSize = 10000.f;
+
+	// Lowest X / Y of the world, the grid starts there
+	UPROPERTY(Config)
+	float SpatialBiasX = -150000.f;
+
+	UPROPERTY(Config)
+	float SpatialBiasY = -200000.f;
+
+	// Destroyed actors further than this from a viewer are not sent to it
+	UPROPERTY(Config)
+	float DestructionInfoMaxDistance = 30000.f;
+};
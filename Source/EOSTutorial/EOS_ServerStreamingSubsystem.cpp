@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_ServerStreamingSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerStart.h"
+#include "WorldPartition/WorldPartitionSubsystem.h"
+#if WITH_EDITOR
+#include "WorldPartition/WorldPartition.h"
+#include "WorldPartition/WorldPartitionHelpers.h"
+#include "WorldPartition/WorldPartitionActorDesc.h"
+#endif
+
+static FWorldPartitionStreamingSource MakeStreamingSource(const FString& Name, const FVector& Location, float LoadingRangeScale, float Radius = 0.f) {
+	FWorldPartitionStreamingSource StreamingSource;
+	StreamingSource.Name = FName(*Name);
+	StreamingSource.Location = Location;
+	StreamingSource.TargetState = EStreamingSourceTargetState::Activated;
+
+	// Without a radius, the loading range of every runtime grid, scaled
+	FStreamingSourceShape& Shape = StreamingSource.Shapes.AddDefaulted_GetRef();
+	Shape.bUseGridLoadingRange = Radius <= 0.f;
+	Shape.Radius = Radius;
+	Shape.LoadingRangeScale = LoadingRangeScale;
+	return StreamingSource;
+}
+
+bool UEOS_ServerStreamingSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+	// Clients stream around their own player controller already
+	return Super::ShouldCreateSubsystem(Outer) && IsRunningDedicatedServer();
+}
+
+void UEOS_ServerStreamingSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+	UWorldPartitionSubsystem* WorldPartitionSubsystem = InWorld.IsPartitionedWorld() ? InWorld.GetSubsystem<UWorldPartitionSubsystem>() : nullptr;
+	if (!WorldPartitionSubsystem) {
+		return;
+	}
+	WorldPartitionSubsystem->RegisterStreamingSourceProvider(this);
+	bIsRegistered = true;
+
+	FindSpawnAreas();
+	if (SpawnAreas.Num() == 0) {
+		UE_LOG(LogTemp, Warning, TEXT("No player start found without loading cells, add the player starts of %s to MapSpawnAreas !"), *InWorld.GetMapName());
+	}
+	UpdateStreamingSources();
+}
+
+void UEOS_ServerStreamingSubsystem::Deinitialize() {
+	UWorldPartitionSubsystem* WorldPartitionSubsystem = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>();
+	if (bIsRegistered && WorldPartitionSubsystem) {
+		WorldPartitionSubsystem->UnregisterStreamingSourceProvider(this);
+	}
+	bIsRegistered = false;
+
+	Super::Deinitialize();
+}
+
+TStatId UEOS_ServerStreamingSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEOS_ServerStreamingSubsystem, STATGROUP_Tickables);
+}
+
+void UEOS_ServerStreamingSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	const double Now = FPlatformTime::Seconds();
+	if (!bIsRegistered || Now < NextUpdateTime) {
+		return;
+	}
+	NextUpdateTime = Now + UpdateInterval;
+
+	UpdateMemoryCaps();
+	UpdateStreamingSources();
+}
+
+bool UEOS_ServerStreamingSubsystem::GetStreamingSources(TArray<FWorldPartitionStreamingSource>& OutStreamingSources) const {
+	OutStreamingSources.Append(StreamingSources);
+	return StreamingSources.Num() > 0;
+}
+
+int32 UEOS_ServerStreamingSubsystem::GetNumberOfLoadedCells() const {
+	int32 NumberOfLoadedCells = 0;
+	for (const ULevelStreaming* StreamingLevel : GetWorld()->GetStreamingLevels()) {
+		if (StreamingLevel && StreamingLevel->IsLevelLoaded()) {
+			NumberOfLoadedCells++;
+		}
+	}
+	return NumberOfLoadedCells;
+}
+
+// Spawn areas of the same player start found twice are merged
+static void AddSpawnArea(TArray<FVector>& SpawnAreas, const FVector& Location) {
+	if (!SpawnAreas.ContainsByPredicate([&Location](const FVector& SpawnArea) { return SpawnArea.Equals(Location, 1.0); })) {
+		SpawnAreas.Add(Location);
+	}
+}
+
+void UEOS_ServerStreamingSubsystem::FindSpawnAreas() {
+	SpawnAreas.Reset();
+
+	// Non spatially loaded player starts are in the persistent level already
+	for (TActorIterator<APlayerStart> PlayerStart(GetWorld()); PlayerStart; ++PlayerStart) {
+		AddSpawnArea(SpawnAreas, PlayerStart->GetActorLocation());
+	}
+
+	// Spatially loaded ones are in cells nothing streams in yet
+	const FString MapPackageName = UWorld::RemovePIEPrefix(GetWorld()->GetOutermost()->GetName());
+	for (const FEOSMapSpawnAreas& MapSpawnArea : MapSpawnAreas) {
+		if (MapSpawnArea.Map == MapPackageName) {
+			for (const FVector& Location : MapSpawnArea.Locations) {
+				AddSpawnArea(SpawnAreas, Location);
+			}
+		}
+	}
+
+#if WITH_EDITOR
+	if (UWorldPartition* WorldPartition = GetWorld()->GetWorldPartition()) {
+		FWorldPartitionHelpers::ForEachActorDesc<APlayerStart>(WorldPartition, [this](const FWorldPartitionActorDesc* ActorDesc) {
+			AddSpawnArea(SpawnAreas, ActorDesc->GetBounds().GetCenter());
+			return true;
+		});
+	}
+#endif
+}
+
+void UEOS_ServerStreamingSubsystem::UpdateMemoryCaps() {
+	// Back under with some room only, so the streaming doesn't flicker around the caps
+	const double ResidentMb = FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0);
+	if (HardResidentMemoryCapMb > 0) {
+		if (!bIsOverHardMemoryCap && ResidentMb > HardResidentMemoryCapMb) {
+			UE_LOG(LogTemp, Warning, TEXT("Resident memory %.0f MB over the %d MB hard cap, evicting cells around the players and turning every player away !"), ResidentMb, HardResidentMemoryCapMb);
+			bIsOverHardMemoryCap = true;
+
+			// Cells streamed out only give their memory back once collected
+			GEngine->ForceGarbageCollection(true);
+		}
+		else if (bIsOverHardMemoryCap && ResidentMb < HardResidentMemoryCapMb * 0.9) {
+			UE_LOG(LogTemp, Log, TEXT("Resident memory %.0f MB back under the %d MB hard cap"), ResidentMb, HardResidentMemoryCapMb);
+			bIsOverHardMemoryCap = false;
+		}
+	}
+
+	if (SoftResidentMemoryCapMb <= 0) {
+		return;
+	}
+
+	if (!bIsOverSoftMemoryCap && ResidentMb > SoftResidentMemoryCapMb) {
+		UE_LOG(LogTemp, Warning, TEXT("Resident memory %.0f MB over the %d MB soft cap, streaming without margin and turning new players away !"), ResidentMb, SoftResidentMemoryCapMb);
+		bIsOverSoftMemoryCap = true;
+
+		// Cells already streamed out only give their memory back once collected
+		GEngine->ForceGarbageCollection(true);
+	}
+	else if (bIsOverSoftMemoryCap && ResidentMb < SoftResidentMemoryCapMb * 0.9) {
+		UE_LOG(LogTemp, Log, TEXT("Resident memory %.0f MB back under the %d MB soft cap"), ResidentMb, SoftResidentMemoryCapMb);
+		bIsOverSoftMemoryCap = false;
+	}
+}
+
+void UEOS_ServerStreamingSubsystem::UpdateStreamingSources() {
+	StreamingSources.Reset();
+
+	for (int32 Index = 0; Index < SpawnAreas.Num(); Index++) {
+		StreamingSources.Add(MakeStreamingSource(FString::Printf(TEXT("EOS_SpawnArea_%d"), Index), SpawnAreas[Index], 1.f, SpawnAreaRadius));
+	}
+
+	// Pooled pawns are never possessed, their parking spot stays unloaded
+	const float LoadingRangeScale = bIsOverHardMemoryCap ? HardCapLoadingRangeScale : bIsOverSoftMemoryCap ? 1.f : 1.f + LoadingRangeMargin;
+	for (FConstPlayerControllerIterator PlayerController = GetWorld()->GetPlayerControllerIterator(); PlayerController; ++PlayerController) {
+		const APawn* Pawn = PlayerController->IsValid() ? (*PlayerController)->GetPawn() : nullptr;
+		if (Pawn) {
+			FWorldPartitionStreamingSource& StreamingSource = StreamingSources.Add_GetRef(MakeStreamingSource(Pawn->GetName(), Pawn->GetActorLocation(), LoadingRangeScale));
+			StreamingSource.Rotation = Pawn->GetActorRotation();
+			StreamingSource.Velocity = Pawn->GetVelocity().Size();
+		}
+	}
+}
@@ -0,0 +1,102 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldPartition/WorldPartitionStreamingSource.h"
+#include "EOS_ServerStreamingSubsystem.generated.h"
+
+/**
+ * Dedicated server World Partition streaming - Cells are loaded around the pawn of every player, with a margin,
+ * and around the player starts so new players always land on loaded ground. Cells nobody is near are unloaded
+ * (wp.Runtime.EnableServerStreaming and wp.Runtime.EnableServerStreamingOut in DefaultEngine.ini).
+ * With server streaming on, the engine also streams around every player controller at the plain loading range.
+ * AEOS_PlayerController switches that source off on the server, so these are the only sources around players
+ * and dropping the margin actually unloads cells.
+ * Spawn areas are found at begin play without loading any cell: player starts that are not spatially loaded are in the
+ * persistent level, spatially loaded ones come from the actor descriptors in editor builds and from MapSpawnAreas in
+ * cooked ones, which have no actor descriptors.
+ * Over SoftResidentMemoryCapMb the margin is dropped and new players are turned away until memory is back under.
+ * HardResidentMemoryCapMb is enforced: over it the cells around the pawns are evicted down to HardCapLoadingRangeScale
+ * of the loading range, and every player is turned away, reservations included.
+ */
+// Locations of the player starts of a map, read from their actor descriptors
+USTRUCT()
+struct FEOSMapSpawnAreas
+{
+	GENERATED_BODY()
+
+	// Long package name of the map
+	UPROPERTY(Config)
+	FString Map;
+
+	UPROPERTY(Config)
+	TArray<FVector> Locations;
+};
+
+UCLASS(config=Game)
+class EOSTUTORIAL_API UEOS_ServerStreamingSubsystem : public UTickableWorldSubsystem, public IWorldPartitionStreamingSourceProvider
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// IWorldPartitionStreamingSourceProvider
+	virtual bool GetStreamingSources(TArray<FWorldPartitionStreamingSource>& OutStreamingSources) const override;
+	virtual const UObject* GetStreamingSourceOwner() const override { return this; }
+
+	bool IsOverSoftMemoryCap() const { return bIsOverSoftMemoryCap || bIsOverHardMemoryCap; }
+	bool IsOverHardMemoryCap() const { return bIsOverHardMemoryCap; }
+
+	int32 GetNumberOfStreamingSources() const { return StreamingSources.Num(); }
+
+	// World Partition cells loaded right now
+	int32 GetNumberOfLoadedCells() const;
+
+private:
+	void FindSpawnAreas();
+	void UpdateMemoryCaps();
+	void UpdateStreamingSources();
+
+	// Seconds between two updates of the streaming sources, cells are loaded ahead of the pawns by the margin anyway
+	UPROPERTY(Config)
+	float UpdateInterval = 0.5f;
+
+	// Share of every grid loading range added around the pawns, so cells are in before a pawn reaches them
+	UPROPERTY(Config)
+	float LoadingRangeMargin = 0.25f;
+
+	// Radius kept loaded around every player start
+	UPROPERTY(Config)
+	float SpawnAreaRadius = 2000.f;
+
+	// Spawn areas of spatially loaded player starts, for cooked builds
+	UPROPERTY(Config)
+	TArray<FEOSMapSpawnAreas> MapSpawnAreas;
+
+	// Resident memory of the process the streaming tries to stay under, 0 for no cap. Soft, players already in can push past it
+	UPROPERTY(Config)
+	int32 SoftResidentMemoryCapMb = 0;
+
+	// Resident memory the streaming evicts cells to get back under, 0 for no cap
+	UPROPERTY(Config)
+	int32 HardResidentMemoryCapMb = 0;
+
+	// Share of every grid loading range kept around the pawns over the hard cap, the rest is unloaded
+	UPROPERTY(Config)
+	float HardCapLoadingRangeScale = 0.5f;
+
+	TArray<FWorldPartitionStreamingSource> StreamingSources;
+	TArray<FVector> SpawnAreas;
+
+	bool bIsRegistered = false;
+	bool bIsOverSoftMemoryCap = false;
+	bool bIsOverHardMemoryCap = false;
+	double NextUpdateTime = 0.0;
+};
@@ -0,0 +1,399 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_SessionOperations.h"
+#include "OnlineSessionSettings.h"
+
+FEOSSessionOperations::FEOSSessionOperations(IOnlineSessionPtr InSessionInterface, const FEOSSessionOperationPolicy& InPolicy)
+	: SessionInterface(InSessionInterface)
+	, Policy(InPolicy)
+{
+	check(InSessionInterface.IsValid());
+
+	// Bind every callback once for the lifetime of this object. Callbacks are routed to the right queue by session name.
+	CreateSessionDelegateHandle = InSessionInterface->AddOnCreateSessionCompleteDelegate_Handle(FOnCreateSessionCompleteDelegate::CreateRaw(this, &FEOSSessionOperations::HandleCreateSessionCompleted));
+	StartSessionDelegateHandle = InSessionInterface->AddOnStartSessionCompleteDelegate_Handle(FOnStartSessionCompleteDelegate::CreateRaw(this, &FEOSSessionOperations::HandleStartSessionCompleted));
+	RegisterPlayersDelegateHandle = InSessionInterface->AddOnRegisterPlayersCompleteDelegate_Handle(FOnRegisterPlayersCompleteDelegate::CreateRaw(this, &FEOSSessionOperations::HandleRegisterPlayersCompleted));
+	UnregisterPlayersDelegateHandle = InSessionInterface->AddOnUnregisterPlayersCompleteDelegate_Handle(FOnUnregisterPlayersCompleteDelegate::CreateRaw(this, &FEOSSessionOperations::HandleUnregisterPlayersCompleted));
+	EndSessionDelegateHandle = InSessionInterface->AddOnEndSessionCompleteDelegate_Handle(FOnEndSessionCompleteDelegate::CreateRaw(this, &FEOSSessionOperations::HandleEndSessionCompleted));
+	DestroySessionDelegateHandle = InSessionInterface->AddOnDestroySessionCompleteDelegate_Handle(FOnDestroySessionCompleteDelegate::CreateRaw(this, &FEOSSessionOperations::HandleDestroySessionCompleted));
+	FindSessionsDelegateHandle = InSessionInterface->AddOnFindSessionsCompleteDelegate_Handle(FOnFindSessionsCompleteDelegate::CreateRaw(this, &FEOSSessionOperations::HandleFindSessionsCompleted));
+	JoinSessionDelegateHandle = InSessionInterface->AddOnJoinSessionCompleteDelegate_Handle(FOnJoinSessionCompleteDelegate::CreateRaw(this, &FEOSSessionOperations::HandleJoinSessionCompleted));
+
+	// Drives timeouts and retry backoff
+	TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FEOSSessionOperations::Tick));
+}
+
+FEOSSessionOperations::~FEOSSessionOperations()
+{
+	Shutdown();
+}
+
+void FEOSSessionOperations::Shutdown()
+{
+	if (bIsShutDown) {
+		return;
+	}
+	bIsShutDown = true;
+
+	FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	TickerHandle.Reset();
+
+	IOnlineSessionPtr Session = SessionInterface.Pin();
+	if (Session.IsValid()) {
+		Session->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionDelegateHandle);
+		Session->ClearOnStartSessionCompleteDelegate_Handle(StartSessionDelegateHandle);
+		Session->ClearOnRegisterPlayersCompleteDelegate_Handle(RegisterPlayersDelegateHandle);
+		Session->ClearOnUnregisterPlayersCompleteDelegate_Handle(UnregisterPlayersDelegateHandle);
+		Session->ClearOnEndSessionCompleteDelegate_Handle(EndSessionDelegateHandle);
+		Session->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionDelegateHandle);
+		Session->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsDelegateHandle);
+		Session->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionDelegateHandle);
+	}
+
+	// The operation in flight ahead of them would never be answered now, don't wait for it
+	TMap<FName, TArray<FOperation>> RemainingQueues = MoveTemp(Queues);
+	Queues.Reset();
+	for (TPair<FName, TArray<FOperation>>& Queue : RemainingQueues) {
+		for (FOperation& Operation : Queue.Value) {
+			if (Operation.Type == EEOSSessionOperationType::Destroy && !Operation.bInFlight && !Operation.bCancelled) {
+				Operation.Issue();
+			}
+		}
+	}
+}
+
+uint32 FEOSSessionOperations::CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings& SessionSettings, const FOnEOSSessionOperationCompleted& OnCompleted)
+{
+	return Enqueue(EEOSSessionOperationType::Create, SessionName, [this, HostingPlayerNum, SessionName, SessionSettings]() {
+		IOnlineSessionPtr Session = SessionInterface.Pin();
+		return Session.IsValid() && Session->CreateSession(HostingPlayerNum, SessionName, SessionSettings);
+	}, OnCompleted);
+}
+
+uint32 FEOSSessionOperations::StartSession(FName SessionName, const FOnEOSSessionOperationCompleted& OnCompleted)
+{
+	return Enqueue(EEOSSessionOperationType::Start, SessionName, [this, SessionName]() {
+		IOnlineSessionPtr Session = SessionInterface.Pin();
+		return Session.IsValid() && Session->StartSession(SessionName);
+	}, OnCompleted);
+}
+
+uint32 FEOSSessionOperations::RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& PlayerIds, const FOnEOSSessionOperationCompleted& OnCompleted)
+{
+	return Enqueue(EEOSSessionOperationType::RegisterPlayers, SessionName, [this, SessionName, PlayerIds]() {
+		IOnlineSessionPtr Session = SessionInterface.Pin();
+		return Session.IsValid() && Session->RegisterPlayers(SessionName, PlayerIds, false);
+	}, OnCompleted, PlayerIds);
+}
+
+uint32 FEOSSessionOperations::UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& PlayerIds, const FOnEOSSessionOperationCompleted& OnCompleted)
+{
+	return Enqueue(EEOSSessionOperationType::UnregisterPlayers, SessionName, [this, SessionName, PlayerIds]() {
+		IOnlineSessionPtr Session = SessionInterface.Pin();
+		return Session.IsValid() && Session->UnregisterPlayers(SessionName, PlayerIds);
+	}, OnCompleted, PlayerIds);
+}
+
+uint32 FEOSSessionOperations::EndSession(FName SessionName, const FOnEOSSessionOperationCompleted& OnCompleted)
+{
+	return Enqueue(EEOSSessionOperationType::End, SessionName, [this, SessionName]() {
+		IOnlineSessionPtr Session = SessionInterface.Pin();
+		return Session.IsValid() && Session->EndSession(SessionName);
+	}, OnCompleted);
+}
+
+uint32 FEOSSessionOperations::DestroySession(FName SessionName, const FOnEOSSessionOperationCompleted& OnCompleted)
+{
+	return Enqueue(EEOSSessionOperationType::Destroy, SessionName, MakeDestroyIssue(SessionName), OnCompleted);
+}
+
+TFunction<bool()> FEOSSessionOperations::MakeDestroyIssue(FName SessionName)
+{
+	return [this, SessionName]() {
+		IOnlineSessionPtr Session = SessionInterface.Pin();
+		return Session.IsValid() && Session->DestroySession(SessionName);
+	};
+}
+
+uint32 FEOSSessionOperations::FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& Search, const FOnEOSSessionOperationCompleted& OnCompleted)
+{
+	return Enqueue(EEOSSessionOperationType::Find, NAME_None, [this, SearchingPlayerNum, Search]() {
+		IOnlineSessionPtr Session = SessionInterface.Pin();
+		return Session.IsValid() && Session->FindSessions(SearchingPlayerNum, Search);
+	}, OnCompleted);
+}
+
+uint32 FEOSSessionOperations::FindSessionById(const FUniqueNetId& SearchingUserId, const FUniqueNetId& SessionId, const TSharedRef<FOnlineSessionSearchResult>& OutSearchResult, const FOnEOSSessionOperationCompleted& OnCompleted)
+{
+	// Searches share the NAME_None queue, the OSS doesn't run two of them at once
+	FUniqueNetIdRef SearchingUserIdRef = SearchingUserId.AsShared();
+	FUniqueNetIdRef SessionIdRef = SessionId.AsShared();
+	TWeakPtr<FEOSSessionOperations> WeakThis = AsShared();
+	return Enqueue(EEOSSessionOperationType::FindById, NAME_None, [this, WeakThis, SearchingUserIdRef, SessionIdRef, OutSearchResult]() {
+		IOnlineSessionPtr Session = SessionInterface.Pin();
+		// This one has no multicast delegate, the answer is routed to the queue from its own delegate
+		return Session.IsValid() && Session->FindSessionById(*SearchingUserIdRef, *SessionIdRef, *SearchingUserIdRef,
+			FOnSingleSessionResultCompleteDelegate::CreateLambda([WeakThis, OutSearchResult](int32 LocalUserNum, bool bWasSuccessful, const FOnlineSessionSearchResult& SearchResult) {
+				TSharedPtr<FEOSSessionOperations> This = WeakThis.Pin();
+				if (This.IsValid()) {
+					*OutSearchResult = SearchResult;
+					This->HandleOperationCallback(NAME_None, EEOSSessionOperationType::FindById, bWasSuccessful);
+				}
+			}));
+	}, OnCompleted);
+}
+
+uint32 FEOSSessionOperations::JoinSession(int32 PlayerNum, FName SessionName, const FOnlineSessionSearchResult& SearchResult, const FOnEOSSessionOperationCompleted& OnCompleted)
+{
+	return Enqueue(EEOSSessionOperationType::Join, SessionName, [this, PlayerNum, SessionName, SearchResult]() {
+		IOnlineSessionPtr Session = SessionInterface.Pin();
+		return Session.IsValid() && Session->JoinSession(PlayerNum, SessionName, SearchResult);
+	}, OnCompleted);
+}
+
+bool FEOSSessionOperations::Cancel(uint32 OperationId)
+{
+	for (TPair<FName, TArray<FOperation>>& Queue : Queues) {
+		for (int32 OperationIndex = 0; OperationIndex < Queue.Value.Num(); OperationIndex++) {
+			FOperation& Operation = Queue.Value[OperationIndex];
+			if (Operation.Id != OperationId) {
+				continue;
+			}
+			if (Operation.bCancelled) {
+				return false;
+			}
+
+			const FName SessionName = Queue.Key;
+			FOnEOSSessionOperationCompleted OnCompleted = Operation.OnCompleted;
+			if (Operation.bInFlight) {
+				Operation.bCancelled = true; // Swallow its callback, the queue moves on once it arrives or times out
+			}
+			else {
+				Queue.Value.RemoveAt(OperationIndex);
+			}
+
+			// Queues can change from here, the owner may queue new operations when notified
+			ProcessQueue(SessionName);
+			OnCompleted.ExecuteIfBound(EEOSSessionOperationResult::Cancelled);
+			return true;
+		}
+	}
+	return false;
+}
+
+void FEOSSessionOperations::CancelAll(FName SessionName)
+{
+	TArray<uint32> OperationIds;
+	if (const TArray<FOperation>* Queue = Queues.Find(SessionName)) {
+		for (const FOperation& Operation : *Queue) {
+			OperationIds.Add(Operation.Id);
+		}
+	}
+	for (uint32 OperationId : OperationIds) {
+		Cancel(OperationId);
+	}
+}
+
+int32 FEOSSessionOperations::GetNumPendingOperations(FName SessionName) const
+{
+	int32 NumPendingOperations = 0;
+	if (const TArray<FOperation>* Queue = Queues.Find(SessionName)) {
+		for (const FOperation& Operation : *Queue) {
+			if (!Operation.bCancelled) {
+				NumPendingOperations++;
+			}
+		}
+	}
+	return NumPendingOperations;
+}
+
+uint32 FEOSSessionOperations::Enqueue(EEOSSessionOperationType Type, FName SessionName, TFunction<bool()>&& Issue, const FOnEOSSessionOperationCompleted& OnCompleted, const TArray<FUniqueNetIdRef>& PlayerIds)
+{
+	if (bIsShutDown) {
+		return 0;
+	}
+
+	FOperation Operation = MakeOperation(Type, SessionName, MoveTemp(Issue), OnCompleted, PlayerIds);
+	const uint32 OperationId = Operation.Id;
+	Queues.FindOrAdd(SessionName).Add(MoveTemp(Operation));
+	ProcessQueue(SessionName);
+	return OperationId;
+}
+
+FEOSSessionOperations::FOperation FEOSSessionOperations::MakeOperation(EEOSSessionOperationType Type, FName SessionName, TFunction<bool()>&& Issue, const FOnEOSSessionOperationCompleted& OnCompleted, const TArray<FUniqueNetIdRef>& PlayerIds)
+{
+	FOperation Operation;
+	Operation.Id = NextOperationId++;
+	Operation.Type = Type;
+	Operation.SessionName = SessionName;
+	Operation.PlayerIds = PlayerIds;
+	Operation.Issue = MoveTemp(Issue);
+	Operation.OnCompleted = OnCompleted;
+	// A failed join means the session is gone or full, retrying the same result won't help
+	Operation.MaxRetries = Type == EEOSSessionOperationType::Join ? 0 : Policy.MaxRetries;
+	return Operation;
+}
+
+void FEOSSessionOperations::ProcessQueue(FName SessionName)
+{
+	TArray<FOperation>* Queue = Queues.Find(SessionName);
+	if (!Queue || Queue->Num() == 0) {
+		return;
+	}
+
+	FOperation& Operation = (*Queue)[0];
+	const double Now = FPlatformTime::Seconds();
+	if (Operation.bInFlight || Now < Operation.NextAttemptTime) {
+		return;
+	}
+
+	Operation.bInFlight = true;
+	Operation.IssueTime = Now;
+	const uint32 OperationId = Operation.Id;
+	TFunction<bool()> Issue = Operation.Issue;
+
+	const bool bWasIssued = Issue();
+
+	// Some subsystems answer synchronously, the operation may already be completed or waiting for a retry
+	Queue = Queues.Find(SessionName);
+	if (!bWasIssued && Queue && Queue->Num() > 0 && (*Queue)[0].Id == OperationId && (*Queue)[0].bInFlight) {
+		HandleFrontOperationResult(SessionName, EEOSSessionOperationResult::Failure);
+	}
+}
+
+void FEOSSessionOperations::HandleFrontOperationResult(FName SessionName, EEOSSessionOperationResult Result)
+{
+	TArray<FOperation>* Queue = Queues.Find(SessionName);
+	if (!Queue || Queue->Num() == 0) {
+		return;
+	}
+
+	FOperation& Operation = (*Queue)[0];
+	Operation.bInFlight = false;
+
+	if (!Operation.bCancelled && Result != EEOSSessionOperationResult::Success && Operation.Attempt < Operation.MaxRetries) {
+		Operation.Attempt++;
+		const float RetryDelay = Policy.RetryDelay * FMath::Pow(2.f, Operation.Attempt - 1);
+		Operation.NextAttemptTime = FPlatformTime::Seconds() + RetryDelay;
+		UE_LOG(LogTemp, Warning, TEXT("Session operation on %s failed, retrying in %.1fs (%d/%d)"), *SessionName.ToString(), RetryDelay, Operation.Attempt, Operation.MaxRetries);
+
+		// The named session of a create that timed out can still exist, with its backend session. The retry would fail with
+		// "already exists" and leak it, destroy it first. Nobody waits for this destroy, it fails when there was nothing to destroy.
+		if (Operation.Type == EEOSSessionOperationType::Create && Result == EEOSSessionOperationResult::TimedOut) {
+			FOperation DestroyOperation = MakeOperation(EEOSSessionOperationType::Destroy, SessionName, MakeDestroyIssue(SessionName), FOnEOSSessionOperationCompleted());
+			DestroyOperation.MaxRetries = 0;
+			Queue->Insert(MoveTemp(DestroyOperation), 0);
+			ProcessQueue(SessionName);
+		}
+		return; // Issued again by Tick once the delay elapsed
+	}
+
+	// A cancelled operation already notified its owner
+	const bool bShouldNotify = !Operation.bCancelled;
+	FOnEOSSessionOperationCompleted OnCompleted = Operation.OnCompleted;
+	Queue->RemoveAt(0);
+	if (Queue->Num() == 0) {
+		Queues.Remove(SessionName);
+	}
+
+	if (bShouldNotify) {
+		OnCompleted.ExecuteIfBound(Result);
+	}
+	ProcessQueue(SessionName);
+}
+
+// Returns true if both arrays hold the same players, in any order
+static bool HasSamePlayers(const TArray<FUniqueNetIdRef>& PlayerIds, const TArray<FUniqueNetIdRef>& OtherPlayerIds)
+{
+	if (PlayerIds.Num() != OtherPlayerIds.Num()) {
+		return false;
+	}
+	for (const FUniqueNetIdRef& PlayerId : PlayerIds) {
+		if (!OtherPlayerIds.ContainsByPredicate([&PlayerId](const FUniqueNetIdRef& OtherPlayerId) { return *OtherPlayerId == *PlayerId; })) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void FEOSSessionOperations::HandleOperationCallback(FName SessionName, EEOSSessionOperationType Type, bool bWasSuccessful, const TArray<FUniqueNetIdRef>* PlayerIds)
+{
+	const TArray<FOperation>* Queue = Queues.Find(SessionName);
+	if (!Queue || Queue->Num() == 0) {
+		return;
+	}
+
+	// Anything else is an answer for another listener of the session interface, or a late answer to an attempt that timed out
+	const FOperation& Operation = (*Queue)[0];
+	if (!Operation.bInFlight || Operation.Type != Type || (PlayerIds && !HasSamePlayers(Operation.PlayerIds, *PlayerIds))) {
+		return;
+	}
+
+	HandleFrontOperationResult(SessionName, bWasSuccessful ? EEOSSessionOperationResult::Success : EEOSSessionOperationResult::Failure);
+}
+
+bool FEOSSessionOperations::Tick(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	TArray<FName> SessionNames;
+	Queues.GetKeys(SessionNames);
+	for (const FName& SessionName : SessionNames) {
+		const TArray<FOperation>* Queue = Queues.Find(SessionName);
+		if (!Queue || Queue->Num() == 0) {
+			continue;
+		}
+
+		const FOperation& Operation = (*Queue)[0];
+		if (Operation.bInFlight && Now - Operation.IssueTime > Policy.Timeout) {
+			UE_LOG(LogTemp, Warning, TEXT("Session operation on %s timed out !"), *SessionName.ToString());
+			HandleFrontOperationResult(SessionName, EEOSSessionOperationResult::TimedOut);
+		}
+		else if (!Operation.bInFlight) {
+			ProcessQueue(SessionName);
+		}
+	}
+
+	return true; // Keep ticking
+}
+
+void FEOSSessionOperations::HandleCreateSessionCompleted(FName SessionName, bool bWasSuccessful)
+{
+	HandleOperationCallback(SessionName, EEOSSessionOperationType::Create, bWasSuccessful);
+}
+
+void FEOSSessionOperations::HandleStartSessionCompleted(FName SessionName, bool bWasSuccessful)
+{
+	HandleOperationCallback(SessionName, EEOSSessionOperationType::Start, bWasSuccessful);
+}
+
+void FEOSSessionOperations::HandleRegisterPlayersCompleted(FName SessionName, const TArray<FUniqueNetIdRef>& PlayerIds, bool bWasSuccessful)
+{
+	HandleOperationCallback(SessionName, EEOSSessionOperationType::RegisterPlayers, bWasSuccessful, &PlayerIds);
+}
+
+void FEOSSessionOperations::HandleUnregisterPlayersCompleted(FName SessionName, const TArray<FUniqueNetIdRef>& PlayerIds, bool bWasSuccessful)
+{
+	HandleOperationCallback(SessionName, EEOSSessionOperationType::UnregisterPlayers, bWasSuccessful, &PlayerIds);
+}
+
+void FEOSSessionOperations::HandleEndSessionCompleted(FName SessionName, bool bWasSuccessful)
+{
+	HandleOperationCallback(SessionName, EEOSSessionOperationType::End, bWasSuccessful);
+}
+
+void FEOSSessionOperations::HandleDestroySessionCompleted(FName SessionName, bool bWasSuccessful)
+{
+	HandleOperationCallback(SessionName, EEOSSessionOperationType::Destroy, bWasSuccessful);
+}
+
+void FEOSSessionOperations::HandleFindSessionsCompleted(bool bWasSuccessful)
+{
+	HandleOperationCallback(NAME_None, EEOSSessionOperationType::Find, bWasSuccessful);
+}
+
+void FEOSSessionOperations::HandleJoinSessionCompleted(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
+{
+	HandleOperationCallback(SessionName, EEOSSessionOperationType::Join, Result == EOnJoinSessionCompleteResult::Success);
+}
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Interfaces/OnlineSessionInterface.h"
+
+class FOnlineSessionSettings;
+class FOnlineSessionSearch;
+
+// Kind of session call, used to match OSS callbacks to the operation waiting for them
+enum class EEOSSessionOperationType : uint8 {
+	Create,
+	Start,
+	RegisterPlayers,
+	UnregisterPlayers,
+	End,
+	Destroy,
+	Find,
+	FindById,
+	Join
+};
+
+// How an operation ended, given back to its owner
+enum class EEOSSessionOperationResult : uint8 {
+	Success,
+	Failure, // The OSS refused the call or the callback reported a failure, after every retry
+	TimedOut, // No callback arrived in time, after every retry
+	Cancelled
+};
+
+DECLARE_DELEGATE_OneParam(FOnEOSSessionOperationCompleted, EEOSSessionOperationResult);
+
+// Timeout and retry rules applied to every operation of a FEOSSessionOperations
+struct FEOSSessionOperationPolicy {
+	float Timeout = 30.f; // Seconds to wait for the OSS callback before considering the attempt failed
+	int32 MaxRetries = 2; // Attempts made after the first one failed
+	float RetryDelay = 1.f; // Delay before the first retry, doubled for every following one
+};
+
+/**
+ * Async layer on top of the OSS session interface.
+ * Every session gets its own queue: operations of a session run one after the other, different sessions run in parallel.
+ * The OSS delegates are bound once and each callback is routed to the operation in flight for its session,
+ * so overlapping operations never lose their callback. Operations can time out, retry with backoff and be cancelled.
+ * Must be created with MakeShared as some OSS calls take a one-off delegate that can outlive this object.
+ */
+class EOSTUTORIAL_API FEOSSessionOperations : public TSharedFromThis<FEOSSessionOperations>
+{
+public:
+	FEOSSessionOperations(IOnlineSessionPtr InSessionInterface, const FEOSSessionOperationPolicy& InPolicy = FEOSSessionOperationPolicy());
+	~FEOSSessionOperations();
+
+	// Every function queues the call and returns an operation id usable with Cancel()
+	uint32 CreateSession(int32 HostingPlayerNum, FName SessionName, const FOnlineSessionSettings& SessionSettings, const FOnEOSSessionOperationCompleted& OnCompleted);
+	uint32 StartSession(FName SessionName, const FOnEOSSessionOperationCompleted& OnCompleted);
+	uint32 RegisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& PlayerIds, const FOnEOSSessionOperationCompleted& OnCompleted);
+	uint32 UnregisterPlayers(FName SessionName, const TArray<FUniqueNetIdRef>& PlayerIds, const FOnEOSSessionOperationCompleted& OnCompleted);
+	uint32 EndSession(FName SessionName, const FOnEOSSessionOperationCompleted& OnCompleted);
+	uint32 DestroySession(FName SessionName, const FOnEOSSessionOperationCompleted& OnCompleted);
+	uint32 FindSessions(int32 SearchingPlayerNum, const TSharedRef<FOnlineSessionSearch>& Search, const FOnEOSSessionOperationCompleted& OnCompleted);
+	// OutSearchResult is filled with the up to date session when the operation succeeds
+	uint32 FindSessionById(const FUniqueNetId& SearchingUserId, const FUniqueNetId& SessionId, const TSharedRef<FOnlineSessionSearchResult>& OutSearchResult, const FOnEOSSessionOperationCompleted& OnCompleted);
+	uint32 JoinSession(int32 PlayerNum, FName SessionName, const FOnlineSessionSearchResult& SearchResult, const FOnEOSSessionOperationCompleted& OnCompleted);
+
+	// Owner is notified with Cancelled right away. An operation already in flight keeps its queue busy until its callback or timeout.
+	bool Cancel(uint32 OperationId);
+	void CancelAll(FName SessionName);
+
+	int32 GetNumPendingOperations(FName SessionName) const;
+
+	// Unbind from the OSS and stop ticking, nobody is notified anymore and later calls are ignored.
+	// Destroys still waiting in a queue are sent right away so the backend stops advertising their session.
+	void Shutdown();
+
+private:
+	struct FOperation {
+		uint32 Id = 0;
+		EEOSSessionOperationType Type = EEOSSessionOperationType::Create;
+		FName SessionName;
+		TArray<FUniqueNetIdRef> PlayerIds; // Register / Unregister only, to match the callback
+		TFunction<bool()> Issue; // Issue the OSS call, false if it couldn't start
+		FOnEOSSessionOperationCompleted OnCompleted;
+		int32 MaxRetries = 0;
+		int32 Attempt = 0;
+		double IssueTime = 0.0;
+		double NextAttemptTime = 0.0;
+		bool bInFlight = false;
+		bool bCancelled = false;
+	};
+
+	uint32 Enqueue(EEOSSessionOperationType Type, FName SessionName, TFunction<bool()>&& Issue, const FOnEOSSessionOperationCompleted& OnCompleted, const TArray<FUniqueNetIdRef>& PlayerIds = TArray<FUniqueNetIdRef>());
+	FOperation MakeOperation(EEOSSessionOperationType Type, FName SessionName, TFunction<bool()>&& Issue, const FOnEOSSessionOperationCompleted& OnCompleted, const TArray<FUniqueNetIdRef>& PlayerIds = TArray<FUniqueNetIdRef>());
+	TFunction<bool()> MakeDestroyIssue(FName SessionName);
+
+	// Issue the front operation of a queue if it is ready
+	void ProcessQueue(FName SessionName);
+
+	// The front operation of a queue got an answer (or timed out). Retry it or complete it.
+	void HandleFrontOperationResult(FName SessionName, EEOSSessionOperationResult Result);
+
+	// Route an OSS callback to the operation in flight for that session, if any
+	void HandleOperationCallback(FName SessionName, EEOSSessionOperationType Type, bool bWasSuccessful, const TArray<FUniqueNetIdRef>* PlayerIds = nullptr);
+
+	bool Tick(float DeltaTime);
+
+	void HandleCreateSessionCompleted(FName SessionName, bool bWasSuccessful);
+	void HandleStartSessionCompleted(FName SessionName, bool bWasSuccessful);
+	void HandleRegisterPlayersCompleted(FName SessionName, const TArray<FUniqueNetIdRef>& PlayerIds, bool bWasSuccessful);
+	void HandleUnregisterPlayersCompleted(FName SessionName, const TArray<FUniqueNetIdRef>& PlayerIds, bool bWasSuccessful);
+	void HandleEndSessionCompleted(FName SessionName, bool bWasSuccessful);
+	void HandleDestroySessionCompleted(FName SessionName, bool bWasSuccessful);
+	void HandleFindSessionsCompleted(bool bWasSuccessful);
+	void HandleJoinSessionCompleted(FName SessionName, EOnJoinSessionCompleteResult::Type Result);
+
+	TWeakPtr<IOnlineSession, ESPMode::ThreadSafe> SessionInterface;
+	FEOSSessionOperationPolicy Policy;
+
+	TMap<FName, TArray<FOperation>> Queues; // Searches aren't tied to a session and share the NAME_None queue
+	uint32 NextOperationId = 1;
+	bool bIsShutDown = false;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+
+	FDelegateHandle CreateSessionDelegateHandle;
+	FDelegateHandle StartSessionDelegateHandle;
+	FDelegateHandle RegisterPlayersDelegateHandle;
+	FDelegateHandle UnregisterPlayersDelegateHandle;
+	FDelegateHandle EndSessionDelegateHandle;
+	FDelegateHandle DestroySessionDelegateHandle;
+	FDelegateHandle FindSessionsDelegateHandle;
+	FDelegateHandle JoinSessionDelegateHandle;
+};
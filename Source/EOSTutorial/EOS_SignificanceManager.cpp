@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_SignificanceManager.h"
+#include "EOS_ReplicationGraph.h"
+#include "IAnimationBudgetAllocator.h"
+#include "SkeletalMeshComponentBudgeted.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/PlayerController.h"
+
+static const FName CharacterSignificanceTag(TEXT("EOSCharacter"));
+
+UEOS_SignificanceManager* UEOS_SignificanceManager::Get(const UWorld* World) {
+	return World ? Cast<UEOS_SignificanceManager>(FSignificanceManagerModule::Get(World)) : nullptr;
+}
+
+void UEOS_SignificanceManager::RegisterCharacter(ACharacter* Character) {
+	if (!Character || SignificanceLevels.IsEmpty()) {
+		return;
+	}
+
+	auto SignificanceFunction = [this](FManagedObjectInfo* ObjectInfo, const FTransform& Viewpoint) -> float {
+		return GetCharacterSignificance(CastChecked<ACharacter>(ObjectInfo->GetObject()), Viewpoint);
+	};
+	auto PostSignificanceFunction = [this](FManagedObjectInfo* ObjectInfo, float OldSignificance, float Significance, bool bFinal) {
+		ApplySignificance(CastChecked<ACharacter>(ObjectInfo->GetObject()), Significance);
+	};
+	RegisterObject(Character, CharacterSignificanceTag, SignificanceFunction, EPostSignificanceType::Sequential, PostSignificanceFunction);
+}
+
+void UEOS_SignificanceManager::UnregisterCharacter(ACharacter* Character) {
+	UnregisterObject(Character);
+}
+
+void UEOS_SignificanceManager::Tick(float DeltaTime) {
+	TimeUntilNextUpdate -= DeltaTime;
+	if (TimeUntilNextUpdate > 0.f) {
+		return;
+	}
+	TimeUntilNextUpdate = SignificanceUpdateInterval;
+
+	// Local players look through their camera, remote ones from their pawn's eyes
+	Viewpoints.Reset();
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It) {
+		const APlayerController* PlayerController = It->Get();
+		FVector Location;
+		FRotator Rotation;
+		if (!PlayerController) {
+			continue;
+		}
+		else if (PlayerController->IsLocalController()) {
+			PlayerController->GetPlayerViewPoint(Location, Rotation);
+		}
+		else if (const APawn* Pawn = PlayerController->GetPawn()) {
+			Pawn->GetActorEyesViewPoint(Location, Rotation);
+		}
+		else {
+			continue;
+		}
+		Viewpoints.Emplace(Rotation, Location);
+	}
+
+	if (!Viewpoints.IsEmpty()) {
+		Update(Viewpoints);
+	}
+}
+
+ETickableTickType UEOS_SignificanceManager::GetTickableTickType() const {
+	return HasAnyFlags(RF_ClassDefaultObject) ? ETickableTickType::Never : ETickableTickType::Always;
+}
+
+UWorld* UEOS_SignificanceManager::GetTickableGameObjectWorld() const {
+	return GetWorld();
+}
+
+TStatId UEOS_SignificanceManager::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEOS_SignificanceManager, STATGROUP_Tickables);
+}
+
+float UEOS_SignificanceManager::GetCharacterSignificance(const ACharacter* Character, const FTransform& Viewpoint) const {
+	if (Character->IsLocallyControlled()) {
+		return GetMaxSignificance();
+	}
+
+	// On the server a remote player's viewpoint is its pawn's eyes. Every pawn would be at full significance from its own
+	// viewpoint, so that one is left out of the max and the other viewers decide the level.
+	if (Character->HasAuthority()) {
+		FVector EyesLocation;
+		FRotator EyesRotation;
+		Character->GetActorEyesViewPoint(EyesLocation, EyesRotation);
+		if (EyesLocation.Equals(Viewpoint.GetLocation(), 1.f)) {
+			return 0.f;
+		}
+	}
+
+	const FVector ToCharacter = Character->GetActorLocation() - Viewpoint.GetLocation();
+	const float Distance = ToCharacter.Size();
+	const int32 LastLevel = SignificanceLevels.Num() - 1;
+	int32 Level = LastLevel;
+	for (int32 Index = 0; Index < LastLevel; Index++) {
+		if (Distance < SignificanceLevels[Index].MaxDistance) {
+			Level = Index;
+			break;
+		}
+	}
+
+	// Out of sight drops one level, except right next to the viewer where it can turn around any time
+	if (Level > 0 && Level < LastLevel) {
+		const bool bIsVisible = Character->GetNetMode() == NM_DedicatedServer
+			? FVector::DotProduct(Viewpoint.GetRotation().GetForwardVector(), ToCharacter.GetSafeNormal()) >= ViewConeCosine
+			: Character->WasRecentlyRendered(0.25f);
+		if (!bIsVisible) {
+			Level++;
+		}
+	}
+
+	return SignificanceLevels.Num() - Level;
+}
+
+void UEOS_SignificanceManager::ApplySignificance(ACharacter* Character, float Significance) const {
+	const int32 Level = FMath::Clamp(SignificanceLevels.Num() - FMath::RoundToInt32(Significance), 0, SignificanceLevels.Num() - 1);
+	const FEOSSignificanceLevel& Settings = SignificanceLevels[Level];
+
+	// Simulated movement only smooths what the server sent, server movement of players is driven by their RPCs
+	if (Character->GetLocalRole() == ROLE_SimulatedProxy || (Character->HasAuthority() && !Character->IsPlayerControlled())) {
+		Character->GetCharacterMovement()->SetComponentTickInterval(Settings.MovementTickInterval);
+	}
+
+	// Budgeted meshes get their tick rate from the animation budget allocator instead, which ranks them by this significance
+	USkeletalMeshComponent* Mesh = Character->GetMesh();
+	IAnimationBudgetAllocator* AnimationBudgetAllocator = IAnimationBudgetAllocator::Get(GetWorld());
+	USkeletalMeshComponentBudgeted* BudgetedMesh = Character->GetNetMode() != NM_DedicatedServer ? Cast<USkeletalMeshComponentBudgeted>(Mesh) : nullptr;
+	if (BudgetedMesh && AnimationBudgetAllocator && AnimationBudgetAllocator->GetEnabled()) {
+		// The pawn we look through never skips a frame
+		AnimationBudgetAllocator->SetComponentSignificance(BudgetedMesh, Significance, Character->IsLocallyControlled());
+	}
+	else if (Mesh) {
+		Mesh->SetComponentTickInterval(Settings.AnimationTickInterval);
+	}
+
+	if (Character->HasAuthority() && Character->GetNetMode() != NM_Standalone && Character->NetUpdateFrequency != Settings.NetUpdateFrequency) {
+		Character->NetUpdateFrequency = Settings.NetUpdateFrequency;
+
+		// The replication graph keeps its own replication period, taken from the class when the actor was added
+		const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+		if (UEOS_ReplicationGraph* ReplicationGraph = NetDriver ? Cast<UEOS_ReplicationGraph>(NetDriver->GetReplicationDriver()) : nullptr) {
+			ReplicationGraph->SetActorReplicationFrequency(Character, Settings.NetUpdateFrequency);
+		}
+	}
+}
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SignificanceManager.h"
+#include "Tickable.h"
+#include "EOS_SignificanceManager.generated.h"
+
+class ACharacter;
+
+// What a character is allowed to cost at one significance level
+USTRUCT()
+struct FEOSSignificanceLevel
+{
+	GENERATED_BODY()
+
+	// Characters closer than this to a viewer get this level
+	UPROPERTY(Config)
+	float MaxDistance = 0.f;
+
+	// Seconds between two movement ticks of simulated characters, 0 for every frame
+	UPROPERTY(Config)
+	float MovementTickInterval = 0.f;
+
+	// Seconds between two animation ticks, 0 for every frame. Unused on clients while the animation budget is enabled.
+	UPROPERTY(Config)
+	float AnimationTickInterval = 0.f;
+
+	// Server only, replications per second
+	UPROPERTY(Config)
+	float NetUpdateFrequency = 100.f;
+};
+
+/**
+ * Buckets characters by distance to the viewers - local players on clients, every connection on the server -
+ * and scales their movement tick, animation tick and net update frequency with their bucket.
+ * Characters out of sight drop one bucket: not rendered recently on clients, behind every viewer on the server.
+ */
+UCLASS()
+class EOSTUTORIAL_API UEOS_SignificanceManager : public USignificanceManager, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+	// Automation tests compute significance for pawns of a test world
+	friend struct FEOSSignificanceManagerTestAccess;
+
+public:
+	static UEOS_SignificanceManager* Get(const UWorld* World);
+
+	void RegisterCharacter(ACharacter* Character);
+	void UnregisterCharacter(ACharacter* Character);
+
+	// FTickableGameObject - Gathers the viewpoints and updates significance every SignificanceUpdateInterval
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	float GetCharacterSignificance(const ACharacter* Character, const FTransform& Viewpoint) const;
+	void ApplySignificance(ACharacter* Character, float Significance) const;
+
+	// Ordered from the most to the least significant, the last one applies to everything further
+	UPROPERTY(Config)
+	TArray<FEOSSignificanceLevel> SignificanceLevels;
+
+	UPROPERTY(Config)
+	float SignificanceUpdateInterval = 0.1f;
+
+	// Server only, cosine of the half angle a viewer is considered to see
+	UPROPERTY(Config)
+	float ViewConeCosine = 0.f;
+
+	// Significance of local players' own pawns, above every level
+	float GetMaxSignificance() const { return SignificanceLevels.Num() + 1.f; }
+
+	TArray<FTransform> Viewpoints;
+	float TimeUntilNextUpdate = 0.f;
+};
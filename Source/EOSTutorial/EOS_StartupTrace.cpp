@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_StartupTrace.h"
+
+FEOSStartupTrace& FEOSStartupTrace::Get() {
+	static FEOSStartupTrace StartupTrace;
+	return StartupTrace;
+}
+
+FEOSStartupTrace::FEOSStartupTrace()
+	: Trace(TEXT("Startup"), { TEXT("ProcessStart"), TEXT("GameInstanceInit"), TEXT("PreloadCompleted"), TEXT("MapLoaded"),
+		TEXT("BeginPlay"), TEXT("CreateSession"), TEXT("SessionAdvertised") }) {
+}
+
+void FEOSStartupTrace::BeginStartup() {
+	// Timing is initialized before main, everything the engine did before the game module counts
+	if (StartupSeconds <= 0.0) {
+		Trace.Begin(GStartTime);
+	}
+}
+
+void FEOSStartupTrace::MarkPhase(EEOSStartupPhase Phase) {
+	if (Trace.Mark((int32)Phase) && Phase == EEOSStartupPhase::SessionAdvertised) {
+		EndStartup();
+	}
+}
+
+void FEOSStartupTrace::EndStartup() {
+	// Phases don't always complete in order (the preload can finish after the map), so every one is given since the process start
+	StartupSeconds = Trace.GetPhaseTime((int32)EEOSStartupPhase::SessionAdvertised) - Trace.GetPhaseTime((int32)EEOSStartupPhase::ProcessStart);
+	const FString Breakdown = Trace.End();
+
+	// Map loaded and sessions up, what every server of the fleet costs before its first player
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	const double ResidentMb = MemoryStats.UsedPhysical / (1024.0 * 1024.0);
+	const double PeakResidentMb = MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0);
+
+	UE_LOG(LogTemp, Log, TEXT("Server advertised %.1f ms after the process started, %.1f MB resident (peak %.1f MB) -%s"), StartupSeconds * 1000.0, ResidentMb, PeakResidentMb, *Breakdown);
+
+	// One line per start, phase columns are milliseconds since the process start
+	Trace.AppendCsvLine(TEXT("Time,ProcessId,TotalMs,ResidentMb,PeakResidentMb"), FString::Printf(TEXT("%s,%u,%.1f,%.1f,%.1f"),
+		*FDateTime::UtcNow().ToIso8601(), FPlatformProcess::GetCurrentProcessId(), StartupSeconds * 1000.0, ResidentMb, PeakResidentMb));
+}
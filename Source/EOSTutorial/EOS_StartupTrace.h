@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EOS_PhaseTrace.h"
+
+// Phases of a dedicated server start, in the order they usually complete
+enum class EEOSStartupPhase : uint8 {
+	ProcessStart,
+	GameInstanceInit, // Engine initialized
+	PreloadCompleted,
+	MapLoaded,
+	BeginPlay,
+	CreateSession,
+	SessionAdvertised, // First EOS session created, players can find this server
+	Count
+};
+
+/**
+ * Timestamps every phase of a dedicated server start, from the process start to the first advertised session,
+ * through FEOSPhaseTrace. Once the first session is advertised, the startup is logged with a per phase breakdown
+ * and the resident memory at that point, and appended to Saved/Logs/StartupTrace.csv.
+ */
+class EOSTUTORIAL_API FEOSStartupTrace
+{
+public:
+	static FEOSStartupTrace& Get();
+
+	// Start recording, from the time the process started
+	void BeginStartup();
+
+	// Record a phase of the running startup, the first time only
+	void MarkPhase(EEOSStartupPhase Phase);
+
+	// Seconds from the process start to the first advertised session, 0 until then
+	double GetStartupSeconds() const { return StartupSeconds; }
+
+private:
+	FEOSStartupTrace();
+
+	void EndStartup();
+
+	FEOSPhaseTrace Trace; // A single run, one phase per EEOSStartupPhase
+	double StartupSeconds = 0.0;
+};
@@ -0,0 +1,309 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "EOS_TelemetrySubsystem.h"
+#include "EOS_ActorPoolSubsystem.h"
+#include "EOS_ServerStreamingSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetworkObjectList.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Engine/Texture.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/SkeletalMesh.h"
+#include "Materials/MaterialInterface.h"
+#include "Sound/SoundBase.h"
+#include "UObject/UObjectIterator.h"
+
+// Label values escape backslashes, double quotes and line feeds, as the text exposition format asks
+static FString EscapeLabelValue(const FString& Value) {
+	return Value.Replace(TEXT("\\"), TEXT("\\\\")).Replace(TEXT("\""), TEXT("\\\"")).Replace(TEXT("\n"), TEXT("\\n"));
+}
+
+FEOSTelemetryHistogram::FEOSTelemetryHistogram(const TArray<float>& InUpperBounds)
+	: UpperBounds(InUpperBounds) {
+	BucketCounts.SetNumZeroed(UpperBounds.Num() + 1);
+}
+
+void FEOSTelemetryHistogram::Add(float Value) {
+	int32 Bucket = 0;
+	while (Bucket < UpperBounds.Num() && Value > UpperBounds[Bucket]) {
+		Bucket++;
+	}
+	BucketCounts[Bucket]++;
+	Sum += Value;
+	Count++;
+}
+
+void FEOSTelemetryHistogram::Write(FString& Out, const TCHAR* Name) const {
+	Out += FString::Printf(TEXT("# TYPE %s histogram\n"), Name);
+	uint64 CumulativeCount = 0;
+	for (int32 Bucket = 0; Bucket < UpperBounds.Num(); Bucket++) {
+		CumulativeCount += BucketCounts[Bucket];
+		Out += FString::Printf(TEXT("%s_bucket{le=\"%g\"} %llu\n"), Name, UpperBounds[Bucket], CumulativeCount);
+	}
+	Out += FString::Printf(TEXT("%s_bucket{le=\"+Inf\"} %llu\n%s_sum %.3f\n%s_count %llu\n"), Name, Count, Name, Sum, Name, Count);
+}
+
+static const TCHAR* GetSessionStateName(EEOSSessionState State) {
+	switch (State) {
+	case EEOSSessionState::Creating: return TEXT("Creating");
+	case EEOSSessionState::Pending: return TEXT("Pending");
+	case EEOSSessionState::Starting: return TEXT("Starting");
+	case EEOSSessionState::InProgress: return TEXT("InProgress");
+	case EEOSSessionState::Ending: return TEXT("Ending");
+	case EEOSSessionState::Ended: return TEXT("Ended");
+	case EEOSSessionState::Destroying: return TEXT("Destroying");
+	}
+	return TEXT("Unknown");
+}
+
+bool UEOS_TelemetrySubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+	// Only the dedicated server reports, clients have nothing to scrape
+	return Super::ShouldCreateSubsystem(Outer) && IsRunningDedicatedServer();
+}
+
+void UEOS_TelemetrySubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	// Milliseconds, around the usual server tick rates
+	FrameTimeHistogram = FEOSTelemetryHistogram({ 8.f, 16.f, 33.f, 50.f, 66.f, 100.f, 250.f, 1000.f });
+	WorldTickHistogram = FEOSTelemetryHistogram({ 1.f, 2.f, 4.f, 8.f, 16.f, 33.f, 66.f, 250.f });
+	ReplicationHistogram = FEOSTelemetryHistogram({ 0.25f, 0.5f, 1.f, 2.f, 4.f, 8.f, 16.f, 33.f });
+	JoinToSpawnHistogram = FEOSTelemetryHistogram({ 50.f, 100.f, 250.f, 500.f, 1000.f, 2500.f, 5000.f, 10000.f });
+	ReplayRecordHistogram = FEOSTelemetryHistogram({ 0.05f, 0.1f, 0.25f, 0.5f, 1.f, 2.f, 4.f, 8.f });
+
+	WorldTickStartHandle = FWorldDelegates::OnWorldTickStart.AddUObject(this, &UEOS_TelemetrySubsystem::HandleWorldTickStart);
+	WorldPostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &UEOS_TelemetrySubsystem::HandleWorldPostActorTick);
+	PostTickFlushHandle = GetWorld()->OnPostTickFlush().AddUObject(this, &UEOS_TelemetrySubsystem::HandlePostTickFlush);
+
+	NextReportTime = FPlatformTime::Seconds() + ReportInterval;
+}
+
+void UEOS_TelemetrySubsystem::Deinitialize() {
+	FWorldDelegates::OnWorldTickStart.Remove(WorldTickStartHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(WorldPostActorTickHandle);
+	GetWorld()->OnPostTickFlush().Remove(PostTickFlushHandle);
+
+	// Last numbers of the process
+	WriteReport();
+
+	Super::Deinitialize();
+}
+
+TStatId UEOS_TelemetrySubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UEOS_TelemetrySubsystem, STATGROUP_Tickables);
+}
+
+void UEOS_TelemetrySubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	FrameTimeHistogram.Add(DeltaTime * 1000.f);
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now >= NextReportTime) {
+		NextReportTime = Now + ReportInterval;
+		WriteReport();
+	}
+}
+
+void UEOS_TelemetrySubsystem::HandleWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaTime) {
+	if (World == GetWorld()) {
+		WorldTickStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void UEOS_TelemetrySubsystem::HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime) {
+	// The net driver tick flush comes right after, it replicates the actors
+	if (World == GetWorld()) {
+		ReplicationStartTime = FPlatformTime::Seconds();
+	}
+}
+
+void UEOS_TelemetrySubsystem::HandlePostTickFlush() {
+	const double Now = FPlatformTime::Seconds();
+	if (ReplicationStartTime > 0.0) {
+		ReplicationHistogram.Add((Now - ReplicationStartTime) * 1000.0);
+		ReplicationStartTime = 0.0;
+	}
+	if (WorldTickStartTime > 0.0) {
+		WorldTickHistogram.Add((Now - WorldTickStartTime) * 1000.0);
+		AverageWorldTickMs = FMath::Lerp(AverageWorldTickMs, (float)((Now - WorldTickStartTime) * 1000.0), 0.05f);
+		if (GetWorld()->IsRecordingReplay()) {
+			WorldTickWhileRecordingMs += (Now - WorldTickStartTime) * 1000.0;
+		}
+		WorldTickStartTime = 0.0;
+	}
+}
+
+void UEOS_TelemetrySubsystem::RecordSessionState(FName HostedSessionName, EEOSSessionState State) {
+	const double Now = FPlatformTime::Seconds();
+	FEOSSessionTelemetry* Session = Sessions.Find(HostedSessionName);
+	if (Session) {
+		SecondsInState[(int32)Session->State] += Now - Session->StateEnterTime;
+	}
+	else {
+		Session = &Sessions.Add(HostedSessionName);
+	}
+	Session->State = State;
+	Session->StateEnterTime = Now;
+}
+
+void UEOS_TelemetrySubsystem::RecordSessionRemoved(FName HostedSessionName) {
+	FEOSSessionTelemetry Session;
+	if (Sessions.RemoveAndCopyValue(HostedSessionName, Session)) {
+		SecondsInState[(int32)Session.State] += FPlatformTime::Seconds() - Session.StateEnterTime;
+	}
+}
+
+void UEOS_TelemetrySubsystem::RecordPlayerJoining(const APlayerController* Player, FName HostedSessionName) {
+	JoiningPlayers.Add(Player, FPlatformTime::Seconds());
+	PlayerSessions.Add(Player, HostedSessionName);
+}
+
+void UEOS_TelemetrySubsystem::RecordPlayerSpawned(const APlayerController* Player) {
+	double JoinTime;
+	if (JoiningPlayers.RemoveAndCopyValue(Player, JoinTime)) {
+		JoinToSpawnHistogram.Add((FPlatformTime::Seconds() - JoinTime) * 1000.0);
+	}
+}
+
+void UEOS_TelemetrySubsystem::RecordPlayerLeft(const APlayerController* Player) {
+	JoiningPlayers.Remove(Player);
+	PlayerSessions.Remove(Player);
+}
+
+void UEOS_TelemetrySubsystem::RecordReplayTick(float Milliseconds) {
+	ReplayRecordHistogram.Add(Milliseconds);
+}
+
+double UEOS_TelemetrySubsystem::GetReplayRecordTickRatio() const {
+	return WorldTickWhileRecordingMs > 0.0 ? ReplayRecordHistogram.Sum / WorldTickWhileRecordingMs : 0.0;
+}
+
+void UEOS_TelemetrySubsystem::RecordAdmission(const TCHAR* Result) {
+	Admissions.FindOrAdd(Result)++;
+}
+
+void UEOS_TelemetrySubsystem::WriteReport() {
+	UWorld* World = GetWorld();
+	if (!World) {
+		return;
+	}
+
+	FString Report;
+	Report.Reserve(8192);
+
+	FrameTimeHistogram.Write(Report, TEXT("eos_server_frame_time_ms"));
+	WorldTickHistogram.Write(Report, TEXT("eos_server_world_tick_ms"));
+	ReplicationHistogram.Write(Report, TEXT("eos_server_replication_ms"));
+	JoinToSpawnHistogram.Write(Report, TEXT("eos_server_join_to_spawn_ms"));
+	ReplayRecordHistogram.Write(Report, TEXT("eos_server_replay_record_ms"));
+
+	Report += FString::Printf(TEXT("# TYPE eos_server_replay_record_tick_ratio gauge\neos_server_replay_record_tick_ratio %.4f\n"), GetReplayRecordTickRatio());
+
+	// Pawns and player states handed back by the actor pool instead of spawned
+	if (const UEOS_ActorPoolSubsystem* ActorPool = World->GetSubsystem<UEOS_ActorPoolSubsystem>()) {
+		const FEOSActorPoolStats& PoolStats = ActorPool->GetStats();
+		Report += FString::Printf(TEXT("# TYPE eos_server_actor_pool_hits_total counter\neos_server_actor_pool_hits_total %llu\n# TYPE eos_server_actor_pool_misses_total counter\neos_server_actor_pool_misses_total %llu\n"),
+			PoolStats.Hits, PoolStats.Misses);
+		Report += FString::Printf(TEXT("# TYPE eos_server_actor_pool_hitch_saved_ms_total counter\neos_server_actor_pool_hitch_saved_ms_total %.3f\n"), PoolStats.HitchSavedMs);
+	}
+
+	// Resident memory decides how many servers fit on a host
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	Report += FString::Printf(TEXT("# TYPE eos_server_resident_memory_bytes gauge\neos_server_resident_memory_bytes %llu\n# TYPE eos_server_peak_resident_memory_bytes gauge\neos_server_peak_resident_memory_bytes %llu\n"),
+		(uint64)MemoryStats.UsedPhysical, (uint64)MemoryStats.PeakUsedPhysical);
+
+	// Cells loaded around the players, the world footprint follows them
+	if (const UEOS_ServerStreamingSubsystem* ServerStreaming = World->GetSubsystem<UEOS_ServerStreamingSubsystem>()) {
+		Report += FString::Printf(TEXT("# TYPE eos_server_streaming_sources gauge\neos_server_streaming_sources %d\n# TYPE eos_server_streaming_loaded_cells gauge\neos_server_streaming_loaded_cells %d\n# TYPE eos_server_streaming_over_soft_memory_cap gauge\neos_server_streaming_over_soft_memory_cap %d\n# TYPE eos_server_streaming_over_hard_memory_cap gauge\neos_server_streaming_over_hard_memory_cap %d\n"),
+			ServerStreaming->GetNumberOfStreamingSources(), ServerStreaming->GetNumberOfLoadedCells(), ServerStreaming->IsOverSoftMemoryCap() ? 1 : 0, ServerStreaming->IsOverHardMemoryCap() ? 1 : 0);
+	}
+
+	Report += TEXT("# TYPE eos_server_admissions_total counter\n");
+	for (const TPair<FString, uint64>& Admission : Admissions) {
+		Report += FString::Printf(TEXT("eos_server_admissions_total{result=\"%s\"} %llu\n"), *EscapeLabelValue(Admission.Key), Admission.Value);
+	}
+
+	// Time spent in every state, by every session since the server started
+	const double Now = FPlatformTime::Seconds();
+	double TotalSecondsInState[UE_ARRAY_COUNT(SecondsInState)];
+	FMemory::Memcpy(TotalSecondsInState, SecondsInState, sizeof(SecondsInState));
+	for (const TPair<FName, FEOSSessionTelemetry>& Session : Sessions) {
+		TotalSecondsInState[(int32)Session.Value.State] += Now - Session.Value.StateEnterTime;
+	}
+	Report += TEXT("# TYPE eos_server_session_state_seconds_total counter\n");
+	for (int32 State = 0; State < UE_ARRAY_COUNT(TotalSecondsInState); State++) {
+		Report += FString::Printf(TEXT("eos_server_session_state_seconds_total{state=\"%s\"} %.3f\n"), GetSessionStateName((EEOSSessionState)State), TotalSecondsInState[State]);
+	}
+
+	// Current state of the sessions hosted right now, and for how long
+	Report += TEXT("# TYPE eos_server_session_state_age_seconds gauge\n");
+	for (const TPair<FName, FEOSSessionTelemetry>& Session : Sessions) {
+		Report += FString::Printf(TEXT("eos_server_session_state_age_seconds{session=\"%s\",state=\"%s\"} %.3f\n"),
+			*EscapeLabelValue(Session.Key.ToString()), GetSessionStateName(Session.Value.State), Now - Session.Value.StateEnterTime);
+	}
+
+	UNetDriver* NetDriver = World->GetNetDriver();
+	if (NetDriver) {
+		Report += FString::Printf(TEXT("# TYPE eos_server_network_objects gauge\neos_server_network_objects %d\n# TYPE eos_server_active_network_objects gauge\neos_server_active_network_objects %d\n"),
+			NetDriver->GetNetworkObjectList().GetAllObjects().Num(), NetDriver->GetNetworkObjectList().GetActiveObjects().Num());
+		Report += FString::Printf(TEXT("# TYPE eos_server_connections gauge\neos_server_connections %d\n"), NetDriver->ClientConnections.Num());
+
+		// Saturation is the outgoing rate against the rate the connection negotiated
+		Report += TEXT("# TYPE eos_server_connection_in_bytes_per_second gauge\n# TYPE eos_server_connection_out_bytes_per_second gauge\n# TYPE eos_server_connection_saturation gauge\n# TYPE eos_server_connection_ping_ms gauge\n");
+		for (const UNetConnection* Connection : NetDriver->ClientConnections) {
+			if (!Connection) {
+				continue;
+			}
+			const APlayerController* Player = Connection->PlayerController;
+			const FString PlayerName = Player && Player->PlayerState ? Player->PlayerState->GetPlayerName() : Connection->LowLevelGetRemoteAddress();
+			const FString Labels = FString::Printf(TEXT("{player=\"%s\",session=\"%s\"}"), *EscapeLabelValue(PlayerName), *EscapeLabelValue(PlayerSessions.FindRef(Player).ToString()));
+			const float Saturation = Connection->CurrentNetSpeed > 0 ? (float)Connection->OutBytesPerSecond / Connection->CurrentNetSpeed : 0.f;
+			Report += FString::Printf(TEXT("eos_server_connection_in_bytes_per_second%s %d\neos_server_connection_out_bytes_per_second%s %d\neos_server_connection_saturation%s %.3f\neos_server_connection_ping_ms%s %.1f\n"),
+				*Labels, Connection->InBytesPerSecond, *Labels, Connection->OutBytesPerSecond, *Labels, Saturation, *Labels, Connection->AvgLag * 1000.f);
+		}
+	}
+
+	// Written next to the report then moved over it, a scraper never reads half a file
+	const FString Path = !ReportPath.IsEmpty() ? ReportPath : FPaths::ProjectSavedDir() / TEXT("Telemetry") / FString::Printf(TEXT("Server_%d.prom"), World->URL.Port);
+	const FString TemporaryPath = Path + TEXT(".tmp");
+	if (!FFileHelper::SaveStringToFile(Report, *TemporaryPath) || !IFileManager::Get().Move(*Path, *TemporaryPath, true)) {
+		UE_LOG(LogTemp, Warning, TEXT("Failed to write telemetry to %s !"), *Path);
+	}
+}
+
+// Count and size of the loaded objects of Class, exclusive resource sizes
+static void LogLoadedObjects(UClass* Class, const TCHAR* Label) {
+	int32 NumberOfObjects = 0;
+	SIZE_T Bytes = 0;
+	for (TObjectIterator<UObject> Object; Object; ++Object) {
+		if (Object->IsA(Class) && !Object->HasAnyFlags(RF_ClassDefaultObject)) {
+			NumberOfObjects++;
+			Bytes += Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		}
+	}
+	UE_LOG(LogTemp, Log, TEXT("  %d %s, %.2f MB"), NumberOfObjects, Label, Bytes / (1024.0 * 1024.0));
+}
+
+static FAutoConsoleCommand ServerMemoryCommand(
+	TEXT("EOS.ServerMemory"),
+	TEXT("Resident memory of this process and the render only assets it still has loaded"),
+	FConsoleCommandDelegate::CreateLambda([]() {
+		const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+		UE_LOG(LogTemp, Log, TEXT("Resident memory %.1f MB, peak %.1f MB"), MemoryStats.UsedPhysical / (1024.0 * 1024.0), MemoryStats.PeakUsedPhysical / (1024.0 * 1024.0));
+
+		// A server cooked with Config/Custom/DedicatedServer only has the engine default textures and materials, and meshes without render data
+		LogLoadedObjects(UTexture::StaticClass(), TEXT("textures"));
+		LogLoadedObjects(UMaterialInterface::StaticClass(), TEXT("materials"));
+		LogLoadedObjects(USoundBase::StaticClass(), TEXT("sounds"));
+		LogLoadedObjects(UStaticMesh::StaticClass(), TEXT("static meshes"));
+		LogLoadedObjects(USkeletalMesh::StaticClass(), TEXT("skeletal meshes"));
+	})
+);
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "EOS_GameSession.h"
+#include "EOS_TelemetrySubsystem.generated.h"
+
+class APlayerController;
+
+// Histogram with fixed bucket upper bounds, counts are cumulative since the server started
+struct FEOSTelemetryHistogram {
+	TArray<float> UpperBounds;
+	TArray<uint64> BucketCounts; // One per upper bound, plus the +Inf bucket
+	double Sum = 0.0;
+	uint64 Count = 0;
+
+	FEOSTelemetryHistogram() = default;
+	explicit FEOSTelemetryHistogram(const TArray<float>& InUpperBounds);
+
+	void Add(float Value);
+
+	// Append the histogram in Prometheus text format
+	void Write(FString& Out, const TCHAR* Name) const;
+};
+
+// Lifecycle of a hosted session as seen by telemetry
+struct FEOSSessionTelemetry {
+	EEOSSessionState State = EEOSSessionState::Creating;
+	double StateEnterTime = 0.0;
+};
+
+/**
+ * Dedicated server telemetry - Samples frame time, replication, connections, session states and join latency
+ * and periodically rewrites them to a Prometheus text file, ready for a node exporter textfile collector or a plain cat.
+ */
+UCLASS(config=Game)
+class EOSTUTORIAL_API UEOS_TelemetrySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Called by AEOS_GameSession every time a hosted session changes state
+	void RecordSessionState(FName HostedSessionName, EEOSSessionState State);
+	void RecordSessionRemoved(FName HostedSessionName);
+
+	// Join to spawn latency, from the game session registering the player to its first pawn
+	void RecordPlayerJoining(const APlayerController* Player, FName HostedSessionName);
+	void RecordPlayerSpawned(const APlayerController* Player);
+	void RecordPlayerLeft(const APlayerController* Player);
+
+	// Time UEOS_DemoNetDriver spent recording the replay this frame
+	void RecordReplayTick(float Milliseconds);
+
+	// Share of the world tick spent recording, over the frames a replay was recorded
+	double GetReplayRecordTickRatio() const;
+
+	// Outcome of the admission control of AEOS_GameSession for a player trying to log in
+	void RecordAdmission(const TCHAR* Result);
+
+	// Smoothed world tick time, over about the last second at the usual server tick rates
+	float GetAverageWorldTickMs() const { return AverageWorldTickMs; }
+
+private:
+	void HandleWorldTickStart(UWorld* World, ELevelTick TickType, float DeltaTime);
+	void HandleWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaTime);
+	void HandlePostTickFlush();
+
+	void WriteReport();
+
+	// Seconds between two reports
+	UPROPERTY(Config)
+	float ReportInterval = 10.f;
+
+	// Report file, defaults to Saved/Telemetry/Server_<Port>.prom
+	UPROPERTY(Config)
+	FString ReportPath;
+
+	FEOSTelemetryHistogram FrameTimeHistogram; // Time between two frames, including the wait for the tick rate
+	FEOSTelemetryHistogram WorldTickHistogram; // Time actually spent ticking the world and replicating
+	FEOSTelemetryHistogram ReplicationHistogram; // Time spent in the net driver tick flush, where actors are replicated
+	FEOSTelemetryHistogram JoinToSpawnHistogram;
+	FEOSTelemetryHistogram ReplayRecordHistogram;
+
+	double WorldTickWhileRecordingMs = 0.0; // World ticks of the frames a replay was recorded, to weigh the recording against
+	float AverageWorldTickMs = 0.f;
+
+	TMap<FString, uint64> Admissions; // Players admitted or turned away, by result
+
+	double WorldTickStartTime = 0.0;
+	double ReplicationStartTime = 0.0;
+	double NextReportTime = 0.0;
+
+	TMap<FName, FEOSSessionTelemetry> Sessions;
+	double SecondsInState[(int32)EEOSSessionState::Destroying + 1] = {}; // Every session, removed ones included
+
+	TMap<const APlayerController*, double> JoiningPlayers; // Registered players waiting for their pawn, with the time they joined
+	TMap<const APlayerController*, FName> PlayerSessions; // Session of every registered player, to label connections
+
+	FDelegateHandle WorldTickStartHandle;
+	FDelegateHandle WorldPostActorTickHandle;
+	FDelegateHandle PostTickFlushHandle;
+};
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+#include "EOS_CharacterMovementComponent.h"
+#include "EOSTutorialCharacter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace EOSCharacterMovementTests {
+	constexpr float MaxAcceleration = 2048.f;
+	constexpr int32 MaxMagnitude = (1 << UEOS_CharacterMovementComponent::AccelerationMagnitudeBits) - 1;
+
+	// Half a yaw step on the full circle plus half a magnitude step
+	float GetMaxRoundTripError(float Size) {
+		constexpr int32 YawSteps = 1 << UEOS_CharacterMovementComponent::AccelerationYawBits;
+		return Size * UE_PI / YawSteps + 0.5f * MaxAcceleration / MaxMagnitude + KINDA_SMALL_NUMBER;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSPlanarAccelerationRoundTripTest, "EOSTutorial.CharacterMovement.PlanarAccelerationRoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSPlanarAccelerationRoundTripTest::RunTest(const FString& Parameters) {
+	using namespace EOSCharacterMovementTests;
+
+	// Every direction, negative yaws included, at a few fractions of MaxAcceleration
+	for (int32 Degrees = -180; Degrees < 180; Degrees += 7) {
+		for (const float Fraction : { 0.01f, 0.25f, 0.5f, 0.99f }) {
+			const float Radians = FMath::DegreesToRadians((float)Degrees);
+			const FVector Acceleration(FMath::Cos(Radians) * Fraction * MaxAcceleration, FMath::Sin(Radians) * Fraction * MaxAcceleration, 0.0);
+
+			uint16 Yaw = 0;
+			uint8 Magnitude = 0;
+			if (!TestTrue(FString::Printf(TEXT("%d degrees at %.2f fits"), Degrees, Fraction), UEOS_CharacterMovementComponent::QuantizePlanarAcceleration(Acceleration, MaxAcceleration, Yaw, Magnitude))) {
+				continue;
+			}
+			TestTrue(TEXT("Yaw fits its bits"), Yaw < (1 << UEOS_CharacterMovementComponent::AccelerationYawBits));
+			TestTrue(TEXT("Magnitude fits its bits"), Magnitude <= MaxMagnitude);
+
+			const FVector Decoded = UEOS_CharacterMovementComponent::DequantizePlanarAcceleration(Yaw, Magnitude, MaxAcceleration);
+			TestTrue(FString::Printf(TEXT("%d degrees at %.2f round trips"), Degrees, Fraction), FVector::Dist(Acceleration, Decoded) <= GetMaxRoundTripError(Acceleration.Size()));
+
+			// The client simulates with the decoded acceleration, quantizing it again must not move it
+			const FVector Simulated = UEOS_CharacterMovementComponent::QuantizeAcceleration(Acceleration, MaxAcceleration);
+			TestTrue(TEXT("Quantization is stable"), UEOS_CharacterMovementComponent::QuantizeAcceleration(Simulated, MaxAcceleration).Equals(Simulated, KINDA_SMALL_NUMBER));
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSPlanarAccelerationEdgeCasesTest, "EOSTutorial.CharacterMovement.PlanarAccelerationEdgeCases", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSPlanarAccelerationEdgeCasesTest::RunTest(const FString& Parameters) {
+	using namespace EOSCharacterMovementTests;
+	uint16 Yaw = 0;
+	uint8 Magnitude = 0;
+
+	// No MaxAcceleration to take a fraction of, the acceleration goes at full precision
+	const FVector Forward(1000.0, 0.0, 0.0);
+	TestFalse(TEXT("Zero MaxAcceleration does not fit"), UEOS_CharacterMovementComponent::QuantizePlanarAcceleration(Forward, 0.f, Yaw, Magnitude));
+	TestFalse(TEXT("Negative MaxAcceleration does not fit"), UEOS_CharacterMovementComponent::QuantizePlanarAcceleration(Forward, -1.f, Yaw, Magnitude));
+	TestEqual(TEXT("Zero MaxAcceleration is left as is"), UEOS_CharacterMovementComponent::QuantizeAcceleration(Forward, 0.f), Forward);
+
+	// Flying and swimming accelerate along Z
+	const FVector Climbing(300.0, 400.0, 500.0);
+	TestFalse(TEXT("Non planar acceleration does not fit"), UEOS_CharacterMovementComponent::QuantizePlanarAcceleration(Climbing, MaxAcceleration, Yaw, Magnitude));
+	TestEqual(TEXT("Non planar acceleration is left as is"), UEOS_CharacterMovementComponent::QuantizeAcceleration(Climbing, MaxAcceleration), Climbing);
+
+	// Full magnitude is the last step exactly, anything above is clamped to it
+	const FVector Full(0.0, -MaxAcceleration, 0.0);
+	TestTrue(TEXT("Full magnitude fits"), UEOS_CharacterMovementComponent::QuantizePlanarAcceleration(Full, MaxAcceleration, Yaw, Magnitude));
+	TestEqual(TEXT("Full magnitude is the last step"), (int32)Magnitude, MaxMagnitude);
+	TestTrue(TEXT("Full magnitude round trips"), UEOS_CharacterMovementComponent::DequantizePlanarAcceleration(Yaw, Magnitude, MaxAcceleration).Equals(Full, 0.01f));
+
+	TestTrue(TEXT("Above MaxAcceleration fits"), UEOS_CharacterMovementComponent::QuantizePlanarAcceleration(Full * 2.0, MaxAcceleration, Yaw, Magnitude));
+	TestEqual(TEXT("Above MaxAcceleration is clamped"), (int32)Magnitude, MaxMagnitude);
+
+	// Zero acceleration is sent as a single bit, but still decodes to zero through the planar path
+	TestTrue(TEXT("Zero acceleration fits"), UEOS_CharacterMovementComponent::QuantizePlanarAcceleration(FVector::ZeroVector, MaxAcceleration, Yaw, Magnitude));
+	TestEqual(TEXT("Zero acceleration has no magnitude"), (int32)Magnitude, 0);
+	TestTrue(TEXT("Zero acceleration round trips"), UEOS_CharacterMovementComponent::DequantizePlanarAcceleration(Yaw, Magnitude, MaxAcceleration).IsNearlyZero());
+	TestEqual(TEXT("Zero acceleration is left as is"), UEOS_CharacterMovementComponent::QuantizeAcceleration(FVector::ZeroVector, MaxAcceleration), FVector::ZeroVector);
+
+	// Right behind, Atan2 gives +/- PI, both wrap to a valid yaw
+	const FVector Backward(-MaxAcceleration * 0.5, -0.001, 0.0);
+	TestTrue(TEXT("Backward fits"), UEOS_CharacterMovementComponent::QuantizePlanarAcceleration(Backward, MaxAcceleration, Yaw, Magnitude));
+	TestTrue(TEXT("Backward yaw fits its bits"), Yaw < (1 << UEOS_CharacterMovementComponent::AccelerationYawBits));
+	TestTrue(TEXT("Backward round trips"), FVector::Dist(Backward, UEOS_CharacterMovementComponent::DequantizePlanarAcceleration(Yaw, Magnitude, MaxAcceleration)) <= GetMaxRoundTripError(Backward.Size()));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSSavedMoveAccelerationTest, "EOSTutorial.CharacterMovement.SavedMoveAcceleration", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSSavedMoveAccelerationTest::RunTest(const FString& Parameters) {
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	GEngine->CreateNewWorldContext(EWorldType::Game).SetCurrentWorld(World);
+
+	AEOSTutorialCharacter* Character = World->SpawnActor<AEOSTutorialCharacter>(FVector::ZeroVector, FRotator::ZeroRotator);
+	UEOS_CharacterMovementComponent* CharacterMovement = Character ? Cast<UEOS_CharacterMovementComponent>(Character->GetCharacterMovement()) : nullptr;
+	if (TestNotNull(TEXT("Character spawned with its movement"), CharacterMovement)) {
+		FNetworkPredictionData_Client_Character* ClientData = CharacterMovement->GetPredictionData_Client_Character();
+		const float MaxAcceleration = CharacterMovement->GetMaxAcceleration();
+
+		// Inputs the engine would round to a tenth, each direction and fraction, as the client saves and sends them
+		for (int32 Degrees = -180; Degrees < 180; Degrees += 11) {
+			for (const float Fraction : { 0.f, 0.013f, 0.37f, 0.71f, 1.f }) {
+				const float Radians = FMath::DegreesToRadians((float)Degrees + 0.37f);
+				const FVector Input(FMath::Cos(Radians) * Fraction * MaxAcceleration, FMath::Sin(Radians) * Fraction * MaxAcceleration, 0.0);
+
+				FSavedMovePtr SavedMove = ClientData->CreateSavedMove();
+				SavedMove->SetMoveFor(Character, 1.f / 60.f, Input, *ClientData);
+
+				FEOSCharacterNetworkMoveData ClientMoveData;
+				ClientMoveData.ClientFillNetworkMoveData(*SavedMove, FCharacterNetworkMoveData::ENetworkMoveType::NewMove);
+				FBitWriter Writer(0, true);
+				ClientMoveData.Serialize(*CharacterMovement, Writer, nullptr, FCharacterNetworkMoveData::ENetworkMoveType::NewMove);
+
+				FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+				FEOSCharacterNetworkMoveData ServerMoveData;
+				ServerMoveData.Serialize(*CharacterMovement, Reader, nullptr, FCharacterNetworkMoveData::ENetworkMoveType::NewMove);
+
+				// The client simulates with the saved acceleration, the server with the one it decoded
+				TestTrue(FString::Printf(TEXT("%d degrees at %.3f decodes to the saved acceleration"), Degrees, Fraction), ServerMoveData.Acceleration == SavedMove->Acceleration);
+			}
+		}
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif
@@ -0,0 +1,240 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "OnlineSubsystem.h"
+#include "OnlineSubsystemNames.h"
+#include "OnlineSessionSettings.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EOS_SessionOperations.h"
+#include "EOS_GameSession.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Reaches into AEOS_GameSession, which only starts hosting on a dedicated server
+struct FEOSGameSessionTestAccess {
+	static void StartHosting(AEOS_GameSession* GameSession, IOnlineSessionPtr SessionInterface, const FEOSSessionOperationPolicy& Policy) {
+		GameSession->SessionOperations = MakeShared<FEOSSessionOperations>(SessionInterface, Policy);
+	}
+
+	static void CreateSession(AEOS_GameSession* GameSession, FName HostedSessionName) {
+		GameSession->CreateSession(HostedSessionName);
+	}
+
+	static void DestroySession(AEOS_GameSession* GameSession, FName HostedSessionName) {
+		GameSession->DestroySession(HostedSessionName);
+	}
+
+	static void EndPlay(AEOS_GameSession* GameSession) {
+		GameSession->EndPlay(EEndPlayReason::Quit);
+	}
+
+	static const FEOSHostedSession* FindHostedSession(const AEOS_GameSession* GameSession, FName HostedSessionName) {
+		return GameSession->HostedSessions.Find(HostedSessionName);
+	}
+};
+
+namespace EOSGameSessionTests {
+	// The Null subsystem answers every call synchronously, so each test runs in a single frame
+	IOnlineSessionPtr GetNullSessionInterface() {
+		IOnlineSubsystem* NullSubsystem = IOnlineSubsystem::Get(NULL_SUBSYSTEM);
+		return NullSubsystem ? NullSubsystem->GetSessionInterface() : nullptr;
+	}
+
+	// A failed attempt waits this long for its retry, long enough for the operation to stay queued during a test
+	FEOSSessionOperationPolicy MakeTestPolicy() {
+		FEOSSessionOperationPolicy Policy;
+		Policy.MaxRetries = 1;
+		Policy.RetryDelay = 60.f;
+		return Policy;
+	}
+
+	FOnlineSessionSettings MakeSessionSettings() {
+		FOnlineSessionSettings SessionSettings;
+		SessionSettings.NumPublicConnections = 2;
+		SessionSettings.bShouldAdvertise = false; // No LAN beacon to bind
+		return SessionSettings;
+	}
+
+	// Create the session outside of the queue, so the next CreateSession of that name fails and waits for its retry
+	void TakeSessionName(const IOnlineSessionPtr& SessionInterface, FName SessionName) {
+		SessionInterface->CreateSession(0, SessionName, MakeSessionSettings());
+	}
+
+	FOnEOSSessionOperationCompleted RecordResult(TArray<EEOSSessionOperationResult>& Results) {
+		return FOnEOSSessionOperationCompleted::CreateLambda([&Results](EEOSSessionOperationResult Result) { Results.Add(Result); });
+	}
+
+	// A game world with nothing in it, enough to spawn a game session
+	UWorld* CreateTestWorld() {
+		UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+		GEngine->CreateNewWorldContext(EWorldType::Game).SetCurrentWorld(World);
+		return World;
+	}
+
+	void DestroyTestWorld(UWorld* World) {
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSSessionOperationsLifecycleTest, "EOSTutorial.SessionOperations.Lifecycle", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSSessionOperationsLifecycleTest::RunTest(const FString& Parameters) {
+	using namespace EOSGameSessionTests;
+	IOnlineSessionPtr SessionInterface = GetNullSessionInterface();
+	if (!SessionInterface.IsValid()) {
+		AddError(TEXT("The Null online subsystem is not available"));
+		return false;
+	}
+
+	const FName SessionName = TEXT("EOSTest_Lifecycle");
+	TSharedRef<FEOSSessionOperations> Operations = MakeShared<FEOSSessionOperations>(SessionInterface, MakeTestPolicy());
+	TArray<EEOSSessionOperationResult> Results;
+
+	Operations->CreateSession(0, SessionName, MakeSessionSettings(), RecordResult(Results));
+	TestTrue(TEXT("Session created"), SessionInterface->GetNamedSession(SessionName) != nullptr);
+	Operations->StartSession(SessionName, RecordResult(Results));
+	Operations->EndSession(SessionName, RecordResult(Results));
+	Operations->DestroySession(SessionName, RecordResult(Results));
+	TestTrue(TEXT("Session destroyed"), SessionInterface->GetNamedSession(SessionName) == nullptr);
+
+	TestEqual(TEXT("Every operation completed"), Results.Num(), 4);
+	TestTrue(TEXT("Every operation succeeded"), !Results.ContainsByPredicate([](EEOSSessionOperationResult Result) { return Result != EEOSSessionOperationResult::Success; }));
+	TestEqual(TEXT("Queue empty"), Operations->GetNumPendingOperations(SessionName), 0);
+
+	Operations->Shutdown();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSSessionOperationsCancelTest, "EOSTutorial.SessionOperations.Cancel", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSSessionOperationsCancelTest::RunTest(const FString& Parameters) {
+	using namespace EOSGameSessionTests;
+	IOnlineSessionPtr SessionInterface = GetNullSessionInterface();
+	if (!SessionInterface.IsValid()) {
+		AddError(TEXT("The Null online subsystem is not available"));
+		return false;
+	}
+
+	const FName SessionName = TEXT("EOSTest_Cancel");
+	TakeSessionName(SessionInterface, SessionName);
+	TSharedRef<FEOSSessionOperations> Operations = MakeShared<FEOSSessionOperations>(SessionInterface, MakeTestPolicy());
+	TArray<EEOSSessionOperationResult> CreateResults;
+	TArray<EEOSSessionOperationResult> DestroyResults;
+
+	// The create fails and waits for its retry, the destroy queues behind it
+	Operations->CreateSession(0, SessionName, MakeSessionSettings(), RecordResult(CreateResults));
+	const uint32 DestroyOperationId = Operations->DestroySession(SessionName, RecordResult(DestroyResults));
+	TestEqual(TEXT("Failed create waits for its retry"), CreateResults.Num(), 0);
+	TestEqual(TEXT("Both operations queued"), Operations->GetNumPendingOperations(SessionName), 2);
+
+	TestTrue(TEXT("Queued destroy cancelled"), Operations->Cancel(DestroyOperationId));
+	TestFalse(TEXT("Cancelled only once"), Operations->Cancel(DestroyOperationId));
+	TestTrue(TEXT("Destroy notified as cancelled"), DestroyResults.Num() == 1 && DestroyResults[0] == EEOSSessionOperationResult::Cancelled);
+	TestTrue(TEXT("Cancelled destroy never issued"), SessionInterface->GetNamedSession(SessionName) != nullptr);
+
+	Operations->CancelAll(SessionName);
+	TestTrue(TEXT("Create notified as cancelled"), CreateResults.Num() == 1 && CreateResults[0] == EEOSSessionOperationResult::Cancelled);
+	TestEqual(TEXT("Queue empty"), Operations->GetNumPendingOperations(SessionName), 0);
+
+	Operations->Shutdown();
+	SessionInterface->DestroySession(SessionName);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSSessionOperationsReentrantCancelTest, "EOSTutorial.SessionOperations.ReentrantCancel", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSSessionOperationsReentrantCancelTest::RunTest(const FString& Parameters) {
+	using namespace EOSGameSessionTests;
+	IOnlineSessionPtr SessionInterface = GetNullSessionInterface();
+	if (!SessionInterface.IsValid()) {
+		AddError(TEXT("The Null online subsystem is not available"));
+		return false;
+	}
+
+	const FName SessionName = TEXT("EOSTest_ReentrantCancel");
+	TakeSessionName(SessionInterface, SessionName);
+	TSharedRef<FEOSSessionOperations> Operations = MakeShared<FEOSSessionOperations>(SessionInterface, MakeTestPolicy());
+	TArray<EEOSSessionOperationResult> DestroyResults;
+
+	// Like the game session going away, the owner queues a destroy from the cancel notification of its create
+	FEOSSessionOperations* OperationsPtr = &Operations.Get();
+	Operations->CreateSession(0, SessionName, MakeSessionSettings(), FOnEOSSessionOperationCompleted::CreateLambda([OperationsPtr, SessionName, &DestroyResults](EEOSSessionOperationResult Result) {
+		if (Result == EEOSSessionOperationResult::Cancelled) {
+			OperationsPtr->DestroySession(SessionName, RecordResult(DestroyResults));
+		}
+	}));
+
+	Operations->CancelAll(SessionName);
+	TestTrue(TEXT("Destroy queued from the cancel notification succeeded"), DestroyResults.Num() == 1 && DestroyResults[0] == EEOSSessionOperationResult::Success);
+	TestTrue(TEXT("Session destroyed"), SessionInterface->GetNamedSession(SessionName) == nullptr);
+	TestEqual(TEXT("Queue empty"), Operations->GetNumPendingOperations(SessionName), 0);
+
+	Operations->Shutdown();
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSGameSessionStateTest, "EOSTutorial.GameSession.CreateAndDestroy", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSGameSessionStateTest::RunTest(const FString& Parameters) {
+	using namespace EOSGameSessionTests;
+	IOnlineSessionPtr SessionInterface = GetNullSessionInterface();
+	if (!SessionInterface.IsValid()) {
+		AddError(TEXT("The Null online subsystem is not available"));
+		return false;
+	}
+
+	UWorld* World = CreateTestWorld();
+	AEOS_GameSession* GameSession = World->SpawnActor<AEOS_GameSession>();
+	FEOSGameSessionTestAccess::StartHosting(GameSession, SessionInterface, MakeTestPolicy());
+
+	const FName SessionName = TEXT("EOSTest_GameSession");
+	FEOSGameSessionTestAccess::CreateSession(GameSession, SessionName);
+	const FEOSHostedSession* HostedSession = FEOSGameSessionTestAccess::FindHostedSession(GameSession, SessionName);
+	TestTrue(TEXT("Created session is pending"), HostedSession && HostedSession->State == EEOSSessionState::Pending);
+
+	FEOSGameSessionTestAccess::DestroySession(GameSession, SessionName);
+	TestNull(TEXT("Destroyed session removed"), FEOSGameSessionTestAccess::FindHostedSession(GameSession, SessionName));
+	TestTrue(TEXT("Session destroyed on the backend"), SessionInterface->GetNamedSession(SessionName) == nullptr);
+
+	// A second destroy of a session that is gone does nothing
+	FEOSGameSessionTestAccess::DestroySession(GameSession, SessionName);
+
+	FEOSGameSessionTestAccess::EndPlay(GameSession);
+	DestroyTestWorld(World);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSGameSessionEndPlayWhileCreatingTest, "EOSTutorial.GameSession.EndPlayWhileCreating", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSGameSessionEndPlayWhileCreatingTest::RunTest(const FString& Parameters) {
+	using namespace EOSGameSessionTests;
+	IOnlineSessionPtr SessionInterface = GetNullSessionInterface();
+	if (!SessionInterface.IsValid()) {
+		AddError(TEXT("The Null online subsystem is not available"));
+		return false;
+	}
+
+	UWorld* World = CreateTestWorld();
+	AEOS_GameSession* GameSession = World->SpawnActor<AEOS_GameSession>();
+	FEOSGameSessionTestAccess::StartHosting(GameSession, SessionInterface, MakeTestPolicy());
+
+	// The create can't complete before the server goes down
+	const FName SessionName = TEXT("EOSTest_EndPlayWhileCreating");
+	TakeSessionName(SessionInterface, SessionName);
+	FEOSGameSessionTestAccess::CreateSession(GameSession, SessionName);
+	const FEOSHostedSession* HostedSession = FEOSGameSessionTestAccess::FindHostedSession(GameSession, SessionName);
+	TestTrue(TEXT("Session still creating"), HostedSession && HostedSession->State == EEOSSessionState::Creating);
+
+	// Cancelling the create removes the session while EndPlay goes through them
+	FEOSGameSessionTestAccess::EndPlay(GameSession);
+	TestNull(TEXT("Cancelled session removed"), FEOSGameSessionTestAccess::FindHostedSession(GameSession, SessionName));
+	TestTrue(TEXT("Session destroyed on the backend anyway"), SessionInterface->GetNamedSession(SessionName) == nullptr);
+
+	DestroyTestWorld(World);
+	return true;
+}
+
+#endif
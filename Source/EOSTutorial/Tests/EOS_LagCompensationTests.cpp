@@ -0,0 +1,190 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "EOS_LagCompensationSubsystem.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Reaches into FEOSPoseHistory, which only exposes the capsules it interpolates
+struct FEOSPoseHistoryTestAccess {
+	// Times of the older and newer frame around Time
+	static bool FindFrameTimes(const FEOSPoseHistory& History, double Time, double& OutOlderTime, double& OutNewerTime, float& OutAlpha) {
+		int32 OlderFrame;
+		int32 NewerFrame;
+		if (!History.FindFrames(Time, OlderFrame, NewerFrame, OutAlpha)) {
+			return false;
+		}
+		OutOlderTime = History.FrameTimes[OlderFrame];
+		OutNewerTime = History.FrameTimes[NewerFrame];
+		return true;
+	}
+
+	static int32 GetNewestFrame(const FEOSPoseHistory& History) {
+		return History.NewestFrame;
+	}
+
+	static SIZE_T GetAllocatedSize(const FEOSPoseHistory& History) {
+		return History.FrameTimes.GetAllocatedSize() + History.Locations.GetAllocatedSize() + History.HalfHeights.GetAllocatedSize()
+			+ History.Radii.GetAllocatedSize() + History.SlotStartTimes.GetAllocatedSize() + History.FreeSlots.GetAllocatedSize();
+	}
+};
+
+namespace EOSLagCompensationTests {
+	constexpr int32 HistoryLength = 4;
+	constexpr float Radius = 40.f;
+	constexpr float HalfHeight = 90.f;
+
+	// Frames at times 1 to NumberOfFrames, the slot moves 100 units along X per second
+	void RecordFrames(FEOSPoseHistory& History, int32 Slot, int32 NumberOfFrames) {
+		for (int32 Frame = 1; Frame <= NumberOfFrames; Frame++) {
+			History.BeginFrame(Frame);
+			History.RecordPose(Slot, FVector(Frame * 100.0, 0.0, 0.0), HalfHeight);
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSPoseHistoryWrapAroundTest, "EOSTutorial.LagCompensation.WrapAround", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSPoseHistoryWrapAroundTest::RunTest(const FString& Parameters) {
+	using namespace EOSLagCompensationTests;
+
+	FEOSPoseHistory History;
+	History.Init(2, HistoryLength);
+	const int32 Slot = History.AllocateSlot(Radius);
+
+	// Six frames in a ring of four, the first two are overwritten
+	RecordFrames(History, Slot, 6);
+	TestEqual(TEXT("Newest frame wrapped around the ring"), FEOSPoseHistoryTestAccess::GetNewestFrame(History), 1);
+	TestEqual(TEXT("Oldest time is the oldest kept frame"), History.GetOldestTime(), 3.0);
+	TestEqual(TEXT("Newest time is the last frame"), History.GetNewestTime(), 6.0);
+
+	FVector Location;
+	float OutHalfHeight;
+	float OutRadius;
+	if (TestTrue(TEXT("Capsule across the wrap"), History.GetCapsule(Slot, 4.5, Location, OutHalfHeight, OutRadius))) {
+		TestTrue(TEXT("Location is interpolated across the wrap"), Location.Equals(FVector(450.0, 0.0, 0.0), KINDA_SMALL_NUMBER));
+		TestEqual(TEXT("Half height is recorded"), OutHalfHeight, HalfHeight);
+		TestEqual(TEXT("Radius is the slot one"), OutRadius, Radius);
+	}
+	if (TestTrue(TEXT("Capsule of an overwritten time"), History.GetCapsule(Slot, 1.0, Location, OutHalfHeight, OutRadius))) {
+		TestTrue(TEXT("Overwritten time is clamped to the oldest frame"), Location.Equals(FVector(300.0, 0.0, 0.0), KINDA_SMALL_NUMBER));
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSPoseHistoryFindFramesTest, "EOSTutorial.LagCompensation.FindFrames", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSPoseHistoryFindFramesTest::RunTest(const FString& Parameters) {
+	using namespace EOSLagCompensationTests;
+
+	FEOSPoseHistory History;
+	History.Init(1, HistoryLength);
+	double OlderTime = 0.0;
+	double NewerTime = 0.0;
+	float Alpha = 0.f;
+	TestFalse(TEXT("No frame before the first one"), FEOSPoseHistoryTestAccess::FindFrameTimes(History, 1.0, OlderTime, NewerTime, Alpha));
+
+	RecordFrames(History, History.AllocateSlot(Radius), 6);
+
+	// Exact frame times, the oldest, one in the middle and the newest
+	struct FExpectedFrames {
+		double Time;
+		double OlderTime;
+		double NewerTime;
+		float Alpha;
+	};
+	const FExpectedFrames ExpectedFrames[] = {
+		{ 3.0, 3.0, 4.0, 0.f },
+		{ 5.0, 5.0, 6.0, 0.f },
+		{ 6.0, 6.0, 6.0, 0.f },
+		// Between two frames
+		{ 3.5, 3.0, 4.0, 0.5f },
+		{ 4.25, 4.0, 5.0, 0.25f },
+		{ 5.75, 5.0, 6.0, 0.75f },
+		// Out of range, clamped to the oldest and the newest frames
+		{ 1.0, 3.0, 4.0, 0.f },
+		{ -10.0, 3.0, 4.0, 0.f },
+		{ 10.0, 6.0, 6.0, 0.f },
+	};
+	for (const FExpectedFrames& Expected : ExpectedFrames) {
+		if (TestTrue(FString::Printf(TEXT("Frames at %.2f"), Expected.Time), FEOSPoseHistoryTestAccess::FindFrameTimes(History, Expected.Time, OlderTime, NewerTime, Alpha))) {
+			TestEqual(FString::Printf(TEXT("Older frame at %.2f"), Expected.Time), OlderTime, Expected.OlderTime);
+			TestEqual(FString::Printf(TEXT("Newer frame at %.2f"), Expected.Time), NewerTime, Expected.NewerTime);
+			TestEqual(FString::Printf(TEXT("Alpha at %.2f"), Expected.Time), Alpha, Expected.Alpha, KINDA_SMALL_NUMBER);
+		}
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSPoseHistoryLineTraceTest, "EOSTutorial.LagCompensation.LineTrace", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSPoseHistoryLineTraceTest::RunTest(const FString& Parameters) {
+	using namespace EOSLagCompensationTests;
+
+	FEOSPoseHistory History;
+	History.Init(3, HistoryLength);
+	const SIZE_T AllocatedSize = FEOSPoseHistoryTestAccess::GetAllocatedSize(History);
+
+	// Near stands at X 500 from the first frame, far at X 1000 from the third one
+	const int32 NearSlot = History.AllocateSlot(Radius);
+	const int32 FarSlot = History.AllocateSlot(Radius);
+	for (int32 Frame = 1; Frame <= 2 * HistoryLength; Frame++) {
+		History.BeginFrame(Frame);
+		History.RecordPose(NearSlot, FVector(500.0, 0.0, 0.0), HalfHeight);
+		if (Frame >= 3) {
+			History.RecordPose(FarSlot, FVector(1000.0, 0.0, 0.0), HalfHeight);
+		}
+	}
+
+	const FVector Start = FVector::ZeroVector;
+	const FVector End(2000.0, 0.0, 0.0);
+	FVector HitLocation;
+	TestEqual(TEXT("Closest capsule is hit"), History.LineTrace(7.0, Start, End, INDEX_NONE, HitLocation), NearSlot);
+	TestTrue(TEXT("Hit is on the segment, closest to the axis"), HitLocation.Equals(FVector(500.0, 0.0, 0.0), 0.01f));
+	TestEqual(TEXT("Ignored slot is passed through"), History.LineTrace(7.0, Start, End, NearSlot, HitLocation), FarSlot);
+	TestEqual(TEXT("Slot is not hit before its first pose"), History.LineTrace(2.5, Start, End, NearSlot, HitLocation), (int32)INDEX_NONE);
+	TestEqual(TEXT("Segment above the capsules misses"), History.LineTrace(7.0, FVector(0.0, 0.0, 500.0), FVector(2000.0, 0.0, 500.0), INDEX_NONE, HitLocation), (int32)INDEX_NONE);
+
+	// Freed slots are gone from every time of the history
+	History.FreeSlot(NearSlot);
+	TestEqual(TEXT("Freed slot is not hit"), History.LineTrace(7.0, Start, End, INDEX_NONE, HitLocation), FarSlot);
+	FVector Location;
+	float OutHalfHeight;
+	float OutRadius;
+	TestFalse(TEXT("Freed slot has no capsule"), History.GetCapsule(NearSlot, 7.0, Location, OutHalfHeight, OutRadius));
+
+	// Queries, frames and slots reuse what Init allocated
+	TestEqual(TEXT("Nothing allocated after Init"), FEOSPoseHistoryTestAccess::GetAllocatedSize(History), AllocatedSize);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSPoseHistoryEmptyTest, "EOSTutorial.LagCompensation.NoSlots", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSPoseHistoryEmptyTest::RunTest(const FString& Parameters) {
+	using namespace EOSLagCompensationTests;
+
+	// MaxCharacters=0 in the config, frames exist but hold no pose
+	FEOSPoseHistory History;
+	History.Init(0, HistoryLength);
+	TestEqual(TEXT("No slot to allocate"), History.AllocateSlot(Radius), (int32)INDEX_NONE);
+	History.BeginFrame(1.0);
+	History.RecordPose(0, FVector::ZeroVector, HalfHeight);
+
+	FVector HitLocation;
+	TestEqual(TEXT("Nothing to hit"), History.LineTrace(1.0, FVector::ZeroVector, FVector(1000.0, 0.0, 0.0), INDEX_NONE, HitLocation), (int32)INDEX_NONE);
+	FVector Location;
+	float OutHalfHeight;
+	float OutRadius;
+	TestFalse(TEXT("No capsule"), History.GetCapsule(0, 1.0, Location, OutHalfHeight, OutRadius));
+
+	// HistoryLength=0, no frame at all
+	FEOSPoseHistory NoHistory;
+	NoHistory.Init(1, 0);
+	NoHistory.BeginFrame(1.0);
+	NoHistory.RecordPose(NoHistory.AllocateSlot(Radius), FVector::ZeroVector, HalfHeight);
+	TestEqual(TEXT("Nothing to hit without frames"), NoHistory.LineTrace(1.0, FVector::ZeroVector, FVector(1000.0, 0.0, 0.0), INDEX_NONE, HitLocation), (int32)INDEX_NONE);
+	return true;
+}
+
+#endif
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "EOS_SignificanceManager.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Reaches into UEOS_SignificanceManager, which only updates from the viewpoints of connected players
+struct FEOSSignificanceManagerTestAccess {
+	static void SetLevels(UEOS_SignificanceManager* SignificanceManager, const TArray<FEOSSignificanceLevel>& SignificanceLevels) {
+		SignificanceManager->SignificanceLevels = SignificanceLevels;
+	}
+
+	// Aggregated the way USignificanceManager::Update does, the max over every viewpoint
+	static int32 GetLevel(const UEOS_SignificanceManager* SignificanceManager, const ACharacter* Character, const TArray<FTransform>& Viewpoints) {
+		float Significance = 0.f;
+		for (const FTransform& Viewpoint : Viewpoints) {
+			Significance = FMath::Max(Significance, SignificanceManager->GetCharacterSignificance(Character, Viewpoint));
+		}
+		return SignificanceManager->SignificanceLevels.Num() - FMath::RoundToInt32(Significance);
+	}
+};
+
+namespace EOSSignificanceManagerTests {
+	TArray<FEOSSignificanceLevel> MakeLevels() {
+		TArray<FEOSSignificanceLevel> SignificanceLevels;
+		for (const float MaxDistance : { 1500.f, 4000.f, 8000.f, 0.f }) {
+			FEOSSignificanceLevel& Level = SignificanceLevels.AddDefaulted_GetRef();
+			Level.MaxDistance = MaxDistance;
+		}
+		return SignificanceLevels;
+	}
+
+	// Viewpoint of a remote player on the server, its pawn's eyes
+	FTransform GetEyesViewpoint(const ACharacter* Character) {
+		FVector Location;
+		FRotator Rotation;
+		Character->GetActorEyesViewPoint(Location, Rotation);
+		return FTransform(Rotation, Location);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FEOSSignificanceOwnViewpointTest, "EOSTutorial.SignificanceManager.OwnViewpointIgnored", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FEOSSignificanceOwnViewpointTest::RunTest(const FString& Parameters) {
+	using namespace EOSSignificanceManagerTests;
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	GEngine->CreateNewWorldContext(EWorldType::Game).SetCurrentWorld(World);
+
+	UEOS_SignificanceManager* SignificanceManager = NewObject<UEOS_SignificanceManager>(World);
+	FEOSSignificanceManagerTestAccess::SetLevels(SignificanceManager, MakeLevels());
+
+	// Two players further apart than every level, each one only sees the other from far away
+	ACharacter* NearCharacter = World->SpawnActor<ACharacter>(FVector::ZeroVector, FRotator::ZeroRotator);
+	ACharacter* FarCharacter = World->SpawnActor<ACharacter>(FVector(100000.0, 0.0, 0.0), FRotator::ZeroRotator);
+	if (TestNotNull(TEXT("Near character spawned"), NearCharacter) && TestNotNull(TEXT("Far character spawned"), FarCharacter)) {
+		const TArray<FTransform> Viewpoints = { GetEyesViewpoint(NearCharacter), GetEyesViewpoint(FarCharacter) };
+		const int32 LastLevel = MakeLevels().Num() - 1;
+		TestEqual(TEXT("Near character is at the level the far viewer gives it"), FEOSSignificanceManagerTestAccess::GetLevel(SignificanceManager, NearCharacter, Viewpoints), LastLevel);
+		TestEqual(TEXT("Far character is at the level the near viewer gives it"), FEOSSignificanceManagerTestAccess::GetLevel(SignificanceManager, FarCharacter, Viewpoints), LastLevel);
+
+		// Within the first level of the other viewer, the pawns are at level 0 again
+		FarCharacter->SetActorLocation(FVector(500.0, 0.0, 0.0));
+		const TArray<FTransform> CloseViewpoints = { GetEyesViewpoint(NearCharacter), GetEyesViewpoint(FarCharacter) };
+		TestEqual(TEXT("Close characters are at the first level"), FEOSSignificanceManagerTestAccess::GetLevel(SignificanceManager, NearCharacter, CloseViewpoints), 0);
+	}
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif
@@ -11,5 +11,9 @@ public class EOSTutorialServerTarget : TargetRules
 		DefaultBuildSettings = BuildSettingsVersion.V4;
 		IncludeOrderVersion = EngineIncludeOrderVersion.Unreal5_3;
 		ExtraModuleNames.Add("EOSTutorial");
+
+		// Config/Custom/DedicatedServer turns off what only matters to a renderer, for the cook and at runtime
+		CustomConfig = "DedicatedServer";
+		BuildEnvironment = TargetBuildEnvironment.Unique;
 	}
 }